@@ -0,0 +1,211 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+//==============================================================================
+/**
+    Cascade of transposed direct form II biquads with plain coefficients,
+    headed by an optional first-order section (so odd-order filters don't
+    pay for a full biquad).
+
+    SampleType is float or double, for a single channel, or a
+    juce::dsp::SIMDRegister of either holding one channel per lane. In the
+    SIMD case all channels share the same coefficients, which are stored
+    pre-broadcast, so the whole stereo pair advances through a single
+    instruction stream. Coefficients are handed over in double precision and
+    rounded to the sample type's.
+
+    Sections whose coefficients are exactly the identity - the first-order
+    head included - are dropped from the chain until they are given
+    something to do again.
+*/
+template <typename SampleType, size_t NumSections>
+class FourKBiquadCascade
+{
+public:
+    // Normalised biquad coefficients: b0, b1, b2, a1, a2 (a0 == 1)
+    using Coefficients = std::array<double, 5>;
+
+    // Normalised first-order coefficients: b0, b1, a1 (a0 == 1)
+    using FirstOrderCoefficients = std::array<double, 3>;
+
+    static constexpr Coefficients identity { 1.0, 0.0, 0.0, 0.0, 0.0 };
+    static constexpr FirstOrderCoefficients firstOrderIdentity { 1.0, 0.0, 0.0 };
+
+    FourKBiquadCascade()
+    {
+        for (size_t i = 0; i < NumSections; ++i)
+            setCoefficients(i, identity);
+
+        setFirstOrderCoefficients(firstOrderIdentity);
+        reset();
+    }
+
+    //==============================================================================
+    void setCoefficients(size_t index, const Coefficients& c) noexcept
+    {
+        auto& section = sections[index];
+        section.b0 = broadcast(c[0]);
+        section.b1 = broadcast(c[1]);
+        section.b2 = broadcast(c[2]);
+        section.a1 = broadcast(c[3]);
+        section.a2 = broadcast(c[4]);
+
+        bool isActive = (c != identity);
+
+        if (isActive == active[index])
+            return;
+
+        // A section rejoining the chain starts from silence; its old state
+        // belongs to whatever it was doing before it was dropped
+        if (isActive)
+        {
+            section.s1 = broadcast(0.0);
+            section.s2 = broadcast(0.0);
+        }
+
+        active[index] = isActive;
+        numActive = 0;
+
+        for (size_t i = 0; i < NumSections; ++i)
+            if (active[i])
+                activeSections[numActive++] = (uint8_t) i;
+    }
+
+    void setFirstOrderCoefficients(const FirstOrderCoefficients& c) noexcept
+    {
+        firstOrder.b0 = broadcast(c[0]);
+        firstOrder.b1 = broadcast(c[1]);
+        firstOrder.a1 = broadcast(c[2]);
+
+        bool isActive = (c != firstOrderIdentity);
+
+        if (isActive && ! firstOrderActive)
+            firstOrder.s1 = broadcast(0.0);
+
+        firstOrderActive = isActive;
+    }
+
+    size_t getNumActiveSections() const noexcept { return numActive; }
+
+    void reset() noexcept
+    {
+        firstOrder.s1 = broadcast(0.0);
+
+        for (auto& section : sections)
+        {
+            section.s1 = broadcast(0.0);
+            section.s2 = broadcast(0.0);
+        }
+    }
+
+    //==============================================================================
+    /** Runs the active sections over the buffer, in place.
+
+        Whether the first-order head is active and how many biquads are
+        active pick one of 2 * (NumSections + 1) kernel instantiations once
+        per call; inside the kernel the sections live in locals, so the
+        compiler is free to keep coefficients and state in registers: no
+        member reloads, pointer chasing or branches per sample.
+    */
+    void process(SampleType* samples, size_t numSamples) noexcept
+    {
+        dispatch(samples, numSamples, std::make_index_sequence<NumSections + 1>());
+    }
+
+private:
+    //==============================================================================
+    struct Section
+    {
+        SampleType b0, b1, b2, a1, a2;
+        SampleType s1, s2;
+    };
+
+    struct FirstOrderSection
+    {
+        SampleType b0, b1, a1;
+        SampleType s1;
+    };
+
+    template <size_t... Counts>
+    void dispatch(SampleType* samples, size_t numSamples, std::index_sequence<Counts...>) noexcept
+    {
+        using Kernel = void (FourKBiquadCascade::*)(SampleType*, size_t);
+        static constexpr Kernel kernels[2][NumSections + 1] =
+        {
+            { &FourKBiquadCascade::processActive<false, Counts>... },
+            { &FourKBiquadCascade::processActive<true, Counts>... }
+        };
+
+        (this->*kernels[firstOrderActive ? 1 : 0][numActive])(samples, numSamples);
+    }
+
+    template <bool WithFirstOrder, size_t NumActive>
+    void processActive(SampleType* samples, size_t numSamples) noexcept
+    {
+        auto head = firstOrder;
+        std::array<Section, NumActive> local;
+
+        for (size_t k = 0; k < NumActive; ++k)
+            local[k] = sections[activeSections[k]];
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            auto x = samples[i];
+
+            if constexpr (WithFirstOrder)
+                x = processFirstOrder(head, x);
+
+            for (size_t k = 0; k < NumActive; ++k)
+                x = processSection(local[k], x);
+
+            samples[i] = x;
+        }
+
+        if constexpr (WithFirstOrder)
+            firstOrder.s1 = head.s1;
+
+        for (size_t k = 0; k < NumActive; ++k)
+        {
+            sections[activeSections[k]].s1 = local[k].s1;
+            sections[activeSections[k]].s2 = local[k].s2;
+        }
+    }
+
+    static SampleType processFirstOrder(FirstOrderSection& section, SampleType x) noexcept
+    {
+        auto y = section.b0 * x + section.s1;
+        section.s1 = section.b1 * x - section.a1 * y;
+        return y;
+    }
+
+    static SampleType processSection(Section& section, SampleType x) noexcept
+    {
+        auto y = section.b0 * x + section.s1;
+        section.s1 = section.b1 * x - section.a1 * y + section.s2;
+        section.s2 = section.b2 * x - section.a2 * y;
+        return y;
+    }
+
+    static SampleType broadcast(double value) noexcept
+    {
+        if constexpr (std::is_floating_point_v<SampleType>)
+            return (SampleType) value;
+        else
+            return SampleType::expand((typename SampleType::ElementType) value);
+    }
+
+    FirstOrderSection firstOrder;
+    bool firstOrderActive = false;
+
+    std::array<Section, NumSections> sections;
+    std::array<bool, NumSections> active {};
+    std::array<uint8_t, NumSections> activeSections {};
+    size_t numActive = 0;
+
+    JUCE_LEAK_DETECTOR(FourKBiquadCascade)
+};
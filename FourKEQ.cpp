@@ -39,10 +39,26 @@ FourKEQ::FourKEQ()
     outputGainParam = parameters.getRawParameterValue("output_gain");
     saturationParam = parameters.getRawParameterValue("saturation");
     oversamplingParam = parameters.getRawParameterValue("oversampling");
-
+    oversamplingModeParam = parameters.getRawParameterValue("os_mode");
+    oversamplingFilterParam = parameters.getRawParameterValue("os_filter");
+    saturationAntialiasParam = parameters.getRawParameterValue("sat_adaa");
+    saturationCurveParam = parameters.getRawParameterValue("sat_curve");
+    renderOversamplingParam = parameters.getRawParameterValue("render_os");
+
+    hpfParkedFrequency = parameters.getParameterRange("hpf_freq").start;
+    lpfParkedFrequency = parameters.getParameterRange("lpf_freq").end;
+
+    // The curve tables are shared by every instance; build them here rather
+    // than on the first audio callback that needs one
+    FourKWaveshaper::get(FourKWaveshaper::curveTanh);
 }
 
-FourKEQ::~FourKEQ() = default;
+FourKEQ::~FourKEQ()
+{
+    designerThread->removeTimeSliceClient(this);
+    cancelPendingUpdate();
+    freeSparePaths();
+}
 
 //==============================================================================
 juce::AudioProcessorValueTreeState::ParameterLayout FourKEQ::createParameterLayout()
@@ -126,8 +142,18 @@ juce::AudioProcessorValueTreeState::ParameterLayout FourKEQ::createParameterLayo
         "saturation", "Saturation",
         juce::NormalisableRange<float>(0.0f, 100.0f, 1.0f),
         20.0f, "%"));
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        "sat_adaa", "Saturation ADAA", false));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "sat_curve", "Saturation Curve", juce::StringArray("Tanh", "Op-Amp", "Transformer"), 0));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "oversampling", "Oversampling", juce::StringArray("1x", "2x", "4x", "8x", "16x", "Auto"), 1));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "os_mode", "Oversampling Mode", juce::StringArray("Full", "Saturator Only"), 0));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        "os_filter", "Oversampling Filter", juce::StringArray("Minimum Phase", "Linear Phase"), 0));
     params.push_back(std::make_unique<juce::AudioParameterChoice>(
-        "oversampling", "Oversampling", juce::StringArray("2x", "4x"), 0));
+        "render_os", "Render Oversampling", juce::StringArray("Live Setting", "4x", "8x", "16x"), 0));
 
     return { params.begin(), params.end() };
 }
@@ -135,55 +161,150 @@ juce::AudioProcessorValueTreeState::ParameterLayout FourKEQ::createParameterLayo
 //==============================================================================
 void FourKEQ::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
+    // Blocks until the designer is out of useTimeSlice()
+    designerThread->removeTimeSliceClient(this);
+
     currentSampleRate = sampleRate;
+    preparedNumChannels = getTotalNumInputChannels();
+    preparedDoublePrecision = isUsingDoublePrecision();
+    preparedNonRealtime = isNonRealtime();
+
+    // Processing is in sub-blocks, whatever the host's block size
+    juce::ignoreUnused(samplesPerBlock);
+
+    // Build only the path for the current configuration; anything still in
+    // flight from before was sized for the old one
+    freeSparePaths();
+    fadingPath.path.reset();
+    crossfadeSamplesRemaining = 0;
+    crossfadeLength = juce::jmax(1, (int) (sampleRate * crossfadeTimeSeconds));
+
+    auto params = readParameters();
+
+    designedConfig = getRequestedConfig(params);
+    path = createPath(designedConfig);
+    pendingLatencySamples = path->latency;
+    setLatencySamples(path->latency);
+    oversampledRate = sampleRate * (path->config.linear ? 1 : path->config.factor);
+
+    // Room for the longest path latency, ADAA's half sample at 2x included
+    float maxLatency = 0.0f;
+
+    for (int stages = 1; stages <= maxOversamplingStages; ++stages)
+        for (auto filterType : { FourKOversamplerBase::filterPolyphaseIIR, FourKOversamplerBase::filterLinearPhaseFIR })
+            maxLatency = juce::jmax(maxLatency, getOversamplerLatency(1 << stages, filterType));
+
+    maxLatency += 0.25f;
+
+    if (preparedDoublePrecision)
+    {
+        prepareEngine<double>(maxLatency);
+        releaseEngine<float>();
+    }
+    else
+    {
+        prepareEngine<float>(maxLatency);
+        releaseEngine<double>();
+    }
+
+    bypassMix.reset(sampleRate, bypassFadeTimeSeconds);
+    bypassMix.setCurrentAndTargetValue(params.bypass ? 1.0f : 0.0f);
+
+    dryDelay = previousDryDelay = path->latency;
+    dryDelayFade.reset(sampleRate, bypassFadeTimeSeconds);
+    dryDelayFade.setCurrentAndTargetValue(1.0f);
+
+    antiderivativeStates.assign((size_t) preparedNumChannels, {});
+    fadingPath.antiderivativeStates.assign((size_t) preparedNumChannels, {});
+
+    dcBlockerCoefficient = std::exp(-juce::MathConstants<double>::twoPi * dcBlockerFrequency / sampleRate);
+    dcEstimates.assign((size_t) preparedNumChannels, 0.0);
+    dcBlockerMix.reset(sampleRate, crossfadeTimeSeconds);
+    dcBlockerMix.setCurrentAndTargetValue(path->config.needsDcBlocker() ? 1.0f : 0.0f);
+
+    // Design synchronously so the first block already has valid coefficients
+    invalidateDesigns();
+    updateFilters(params);
+    hasHeldCoefficients = false;
+
+    if (coefficientHandoff.acquire())
+        smoothing.setTarget(coefficientHandoff.getReadBuffer());
+
+    smoothing.snapToTarget();
+
+    if (preparedDoublePrecision)
+        applyCoefficients<double>(smoothing.current);
+    else
+        applyCoefficients<float>(smoothing.current);
+
+    smoothing.setRates(sampleRate * path->config.getFilterFactor(), sampleRate * path->config.factor);
+    smoothing.samplesUntilTick = 0;
+    smoothing.outputGain.reset(sampleRate, 0.02);
+    smoothing.outputGain.setCurrentAndTargetValue(params.outputGain);
+    smoothing.saturation.setCurrentAndTargetValue(params.saturation);
 
-    // Initialize oversampling
-    oversampler2x = std::make_unique<juce::dsp::Oversampling<float>>(
-        getTotalNumInputChannels(), 1,
-        juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR);
+    designerThread->addTimeSliceClient(this, designerIntervalMs);
+}
+
+template <typename SampleType>
+void FourKEQ::prepareEngine(float maxLatency)
+{
+    auto& engine = getEngine<SampleType>();
+
+    engine.crossfadeBuffer.setSize(preparedNumChannels, subBlockSize);
 
-    oversampler4x = std::make_unique<juce::dsp::Oversampling<float>>(
-        getTotalNumInputChannels(), 2,
-        juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR);
+    engine.bypassDelay.setMaximumDelayInSamples((int) std::ceil(maxLatency) + 4);
+    engine.bypassDelay.prepare({ currentSampleRate, (juce::uint32) subBlockSize,
+                                 (juce::uint32) preparedNumChannels });
+    engine.bypassDelay.setDelay((SampleType) path->latency);
+    engine.dryBuffer.setSize(preparedNumChannels, subBlockSize);
 
-    oversampler2x->initProcessing(samplesPerBlock);
-    oversampler4x->initProcessing(samplesPerBlock);
+    // Prepare filters; unused SIMD lanes stay at zero from here on
+    auto numFrameChains = (size_t) (preparedNumChannels + ChannelFrame<SampleType>::size() - 1)
+                        / ChannelFrame<SampleType>::size();
 
-    // Prepare filters
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate * oversamplingFactor;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
+    engine.frameChains.resize(numFrameChains);
+    engine.fadingFrameChains.resize(numFrameChains);
 
-    hpfFilter.prepare(spec);
-    lpfFilter.prepare(spec);
-    lfFilter.prepare(spec);
-    lmFilter.prepare(spec);
-    hmFilter.prepare(spec);
-    hfFilter.prepare(spec);
+    for (auto& chain : engine.frameChains)
+        chain.reset();
+
+    engine.monoChain.reset();
+    engine.frameScratch.fill(ChannelFrame<SampleType>::expand((SampleType) 0));
+}
+
+template <typename SampleType>
+void FourKEQ::releaseEngine()
+{
+    auto& engine = getEngine<SampleType>();
 
-    updateFilters();
+    engine.frameChains.clear();
+    engine.fadingFrameChains.clear();
+    engine.monoChain.reset();
+    engine.crossfadeBuffer.setSize(0, 0);
+    engine.dryBuffer.setSize(0, 0);
 }
 
 void FourKEQ::releaseResources()
 {
-    hpfFilter.reset();
-    lpfFilter.reset();
-    lfFilter.reset();
-    lmFilter.reset();
-    hmFilter.reset();
-    hfFilter.reset();
+    designerThread->removeTimeSliceClient(this);
 
-    if (oversampler2x) oversampler2x->reset();
-    if (oversampler4x) oversampler4x->reset();
+    releaseEngine<float>();
+    releaseEngine<double>();
+
+    path.reset();
+    fadingPath.path.reset();
+    crossfadeSamplesRemaining = 0;
+    freeSparePaths();
 }
 
 //==============================================================================
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool FourKEQ::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-        && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout, mono to immersive, as long as it comes out as it went in;
+    // every channel gets the same EQ
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
@@ -194,7 +315,18 @@ bool FourKEQ::isBusesLayoutSupported(const BusesLayout& layouts) const
 #endif
 
 //==============================================================================
-void FourKEQ::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void FourKEQ::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    process(buffer);
+}
+
+void FourKEQ::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    process(buffer);
+}
+
+template <typename SampleType>
+void FourKEQ::process(juce::AudioBuffer<SampleType>& buffer)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels = getTotalNumInputChannels();
@@ -203,211 +335,1217 @@ void FourKEQ::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& m
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    // Check bypass
-    if (bypassParam->load() > 0.5f)
+    // Only the engine for the precision prepareToPlay saw is allocated
+    if (preparedDoublePrecision != std::is_same_v<SampleType, double>)
+    {
+        jassertfalse;
         return;
+    }
+
+    // Nothing below touches the parameter atomics
+    auto params = readParameters();
+
+    // Offline renders can't rely on the designer thread keeping pace with
+    // automation, so design inline; blocking is acceptable when not realtime.
+    // New paths still only come from the designer thread, so this never
+    // allocates.
+    if (isNonRealtime())
+    {
+        const juce::SpinLock::ScopedLockType lock(designLock);
+        updateFilters(params);
+    }
+
+    // Oversampling switches happen at block boundaries, one at a time
+    retireFadingPath();
+    adoptPendingPath<SampleType>();
 
-    // Update filter coefficients if needed
-    updateFilters();
+    bypassMix.setTargetValue(params.bypass ? 1.0f : 0.0f);
 
-    // Choose oversampling
-    oversamplingFactor = (oversamplingParam->load() < 0.5f) ? 2 : 4;
-    auto& oversampler = (oversamplingFactor == 2) ? *oversampler2x : *oversampler4x;
+    // Whatever the host sends, the chain only ever sees sub-blocks it was
+    // prepared for
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+    auto numSamples = block.getNumSamples();
 
-    // Create audio block and oversample
-    juce::dsp::AudioBlock<float> block(buffer);
-    auto oversampledBlock = oversampler.processSamplesUp(block);
+    for (size_t position = 0; position < numSamples; position += (size_t) subBlockSize)
+    {
+        auto subBlock = block.getSubBlock(position, juce::jmin(numSamples - position, (size_t) subBlockSize));
+        processSubBlock(subBlock, params);
+    }
+}
 
-    auto numChannels = oversampledBlock.getNumChannels();
-    auto numSamples = oversampledBlock.getNumSamples();
+template <typename SampleType>
+void FourKEQ::processSubBlock(juce::dsp::AudioBlock<SampleType>& block, const ParameterSnapshot& params)
+{
+    delayDrySignal(block);
 
-    // Process each channel
-    for (size_t channel = 0; channel < numChannels; ++channel)
+    if (! bypassMix.isSmoothing() && bypassMix.getTargetValue() > 0.5f)
     {
-        auto* channelData = oversampledBlock.getChannelPointer(channel);
+        // Fully bypassed: latency-matched dry signal only. Neither path is
+        // heard, so a switch in flight just runs out its time, which keeps
+        // the next one from starting while the dry tap is still moving.
+        crossfadeSamplesRemaining = juce::jmax(0, crossfadeSamplesRemaining - (int) block.getNumSamples());
+        mixInDrySignal(block);
+        return;
+    }
 
-        for (size_t sample = 0; sample < numSamples; ++sample)
+    smoothing.saturation.setTargetValue(params.saturation);
+    smoothing.outputGain.setTargetValue(params.outputGain);
+
+    if (crossfadeSamplesRemaining > 0)
+        processFadingPath(block);
+
+    auto& live = path->template get<SampleType>();
+
+    if (live.oversampler == nullptr)
+    {
+        // 1x, or linear standing in for an oversampler
+        processFilters(block, ! path->config.linear);
+
+        if (path->config.linear)
+            delayBlock(block, live.latencyDelay);
+    }
+    else if (path->config.saturatorOnly)
+    {
+        // Filters at the host rate; only the saturator needs the bandwidth
+        processFilters(block, false);
+
+        auto oversampledBlock = live.oversampler->processSamplesUp(block);
+        saturateBlock(oversampledBlock, smoothing.saturation, FourKWaveshaper::get(path->config.curve),
+                      path->config.antiderivative ? antiderivativeStates.data() : nullptr);
+
+        if (path->padding > 0.0f)
+            delayBlock(oversampledBlock, live.padDelay);
+
+        live.oversampler->processSamplesDown(block);
+    }
+    else
+    {
+        auto oversampledBlock = live.oversampler->processSamplesUp(block);
+        processFilters(oversampledBlock, true);
+
+        if (path->padding > 0.0f)
+            delayBlock(oversampledBlock, live.padDelay);
+
+        live.oversampler->processSamplesDown(block);
+    }
+
+    if (crossfadeSamplesRemaining > 0)
+        mixInFadingPath(block);
+
+    removeSaturationDC(block);
+    applyOutputGain(block);
+
+    if (bypassMix.isSmoothing())
+        mixInDrySignal(block);
+}
+
+void FourKEQ::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processBypassed(buffer);
+}
+
+void FourKEQ::processBlockBypassed(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processBypassed(buffer);
+}
+
+template <typename SampleType>
+void FourKEQ::processBypassed(juce::AudioBuffer<SampleType>& buffer)
+{
+    // Host-side bypass keeps the reported latency, so PDC stays valid
+    for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
+        buffer.clear(i, 0, buffer.getNumSamples());
+
+    if (preparedDoublePrecision != std::is_same_v<SampleType, double>)
+    {
+        jassertfalse;
+        return;
+    }
+
+    bypassMix.setCurrentAndTargetValue(1.0f);
+
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+    auto numSamples = block.getNumSamples();
+
+    for (size_t position = 0; position < numSamples; position += (size_t) subBlockSize)
+    {
+        auto subBlock = block.getSubBlock(position, juce::jmin(numSamples - position, (size_t) subBlockSize));
+        delayDrySignal(subBlock);
+        mixInDrySignal(subBlock);
+    }
+}
+
+juce::AudioProcessorParameter* FourKEQ::getBypassParameter() const
+{
+    return parameters.getParameter("bypass");
+}
+
+template <typename SampleType>
+void FourKEQ::delayDrySignal(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    auto& engine = getEngine<SampleType>();
+    auto numSamples = (int) block.getNumSamples();
+
+    if (! dryDelayFade.isSmoothing())
+    {
+        for (int channel = 0; channel < preparedNumChannels; ++channel)
         {
-            float processSample = channelData[sample];
+            auto* input = block.getChannelPointer((size_t) channel);
+            auto* dry = engine.dryBuffer.getWritePointer(channel);
 
-            // Apply HPF (two stages for 18dB/oct)
-            if (channel == 0)
+            for (int i = 0; i < numSamples; ++i)
             {
-                processSample = hpfFilter.stage1.filter.processSample(processSample);
-                processSample = hpfFilter.stage2.filter.processSample(processSample);
+                engine.bypassDelay.pushSample(channel, input[i]);
+                dry[i] = engine.bypassDelay.popSample(channel, (SampleType) dryDelay);
             }
+        }
+
+        return;
+    }
+
+    // Read both taps and fade across, rather than jumping under a dry signal
+    // that may be audible
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto mix = (SampleType) dryDelayFade.getNextValue();
+
+        for (int channel = 0; channel < preparedNumChannels; ++channel)
+        {
+            engine.bypassDelay.pushSample(channel, block.getChannelPointer((size_t) channel)[i]);
+
+            auto previous = engine.bypassDelay.popSample(channel, (SampleType) previousDryDelay, false);
+            auto current = engine.bypassDelay.popSample(channel, (SampleType) dryDelay, true);
+            engine.dryBuffer.setSample(channel, i, previous + mix * (current - previous));
+        }
+    }
+}
+
+template <typename SampleType>
+void FourKEQ::mixInDrySignal(juce::dsp::AudioBlock<SampleType>& block)
+{
+    auto& dryBuffer = getEngine<SampleType>().dryBuffer;
+    auto numSamples = (int) block.getNumSamples();
+
+    if (! bypassMix.isSmoothing())
+    {
+        // Fully dry
+        for (int channel = 0; channel < preparedNumChannels; ++channel)
+            std::copy_n(dryBuffer.getReadPointer(channel), numSamples, block.getChannelPointer((size_t) channel));
+
+        return;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto mix = (SampleType) bypassMix.getNextValue();
+
+        for (int channel = 0; channel < preparedNumChannels; ++channel)
+        {
+            auto* output = block.getChannelPointer((size_t) channel);
+            output[i] += mix * (dryBuffer.getSample(channel, i) - output[i]);
+        }
+    }
+}
+
+template <typename SampleType>
+void FourKEQ::removeSaturationDC(juce::dsp::AudioBlock<SampleType>& block)
+{
+    if (! dcBlockerMix.isSmoothing() && dcBlockerMix.getTargetValue() <= 0.0f)
+    {
+        std::fill(dcEstimates.begin(), dcEstimates.end(), 0.0);
+        return;
+    }
+
+    auto numSamples = block.getNumSamples();
+
+    // Subtracting a 5 Hz low-pass of the signal leaves it high-passed
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        auto mix = (double) dcBlockerMix.getNextValue();
+
+        for (int channel = 0; channel < preparedNumChannels; ++channel)
+        {
+            auto* samples = block.getChannelPointer((size_t) channel);
+            auto& estimate = dcEstimates[(size_t) channel];
+
+            estimate += (1.0 - dcBlockerCoefficient) * (samples[i] - estimate);
+            samples[i] -= (SampleType) (mix * estimate);
+        }
+    }
+}
+
+template <typename SampleType>
+void FourKEQ::applyOutputGain(juce::dsp::AudioBlock<SampleType>& block)
+{
+    auto numSamples = block.getNumSamples();
+
+    if (! smoothing.outputGain.isSmoothing())
+    {
+        block.multiplyBy((SampleType) smoothing.outputGain.getTargetValue());
+        return;
+    }
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        auto gain = (SampleType) smoothing.outputGain.getNextValue();
+
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+            block.getChannelPointer(channel)[i] *= gain;
+    }
+}
+
+template <typename SampleType>
+void FourKEQ::processFilters(juce::dsp::AudioBlock<SampleType>& block, bool withSaturation)
+{
+    auto& engine = getEngine<SampleType>();
+    auto numSamples = block.getNumSamples();
+
+    std::array<float, SmoothingEngine::controlInterval> saturationRamp;
+    const auto& curve = FourKWaveshaper::get(path->config.curve);
+    auto* antiderivative = path->config.antiderivative ? antiderivativeStates.data() : nullptr;
+
+    // The saturator runs in the oversampled domain after the LPF. ADAA keeps
+    // running at zero, so its half-sample delay stays put; plain saturation
+    // at zero is a straight wire, so a ramp that lands there mid-block can
+    // run out the block as it is.
+    auto saturation = saturationOff;
+
+    if (withSaturation && antiderivative != nullptr)
+        saturation = saturationAntiderivative;
+    else if (withSaturation && (smoothing.saturation.isSmoothing() || smoothing.saturation.getTargetValue() > 0.0f))
+        saturation = saturationPlain;
+
+    const auto kernel = getChunkKernel<SampleType>(block.getNumChannels(), saturation);
+
+    // Process in control-rate chunks; ticks stay on a fixed grid across blocks
+    for (size_t position = 0; position < numSamples;)
+    {
+        if (smoothing.samplesUntilTick == 0)
+        {
+            // Pick up coefficients published by the designer thread
+            if (coefficientHandoff.acquire())
+                receiveCoefficients(coefficientHandoff.getReadBuffer());
+
+            if (smoothing.tick())
+                applyCoefficients<SampleType>(smoothing.current);
+
+            smoothing.samplesUntilTick = SmoothingEngine::controlInterval;
+        }
+
+        auto chunkEnd = juce::jmin(numSamples, position + (size_t) smoothing.samplesUntilTick);
+        auto chunkLength = chunkEnd - position;
+
+        if (saturation != saturationOff)
+            for (size_t i = 0; i < chunkLength; ++i)
+                saturationRamp[i] = smoothing.saturation.getNextValue();
+
+        (this->*kernel)(engine.frameChains, engine.monoChain, block, position, chunkLength,
+                        saturationRamp.data(), curve, antiderivative);
+
+        smoothing.samplesUntilTick -= (int) chunkLength;
+        position = chunkEnd;
+    }
+}
+
+template <typename SampleType>
+FourKEQ::ChunkKernel<SampleType> FourKEQ::getChunkKernel(size_t numChannels, SaturationMode saturation) noexcept
+{
+    static constexpr ChunkKernel<SampleType> kernels[2][numSaturationModes] =
+    {
+        {
+            &FourKEQ::processChunk<SampleType, false, saturationOff>,
+            &FourKEQ::processChunk<SampleType, false, saturationPlain>,
+            &FourKEQ::processChunk<SampleType, false, saturationAntiderivative>
+        },
+        {
+            &FourKEQ::processChunk<SampleType, true, saturationOff>,
+            &FourKEQ::processChunk<SampleType, true, saturationPlain>,
+            &FourKEQ::processChunk<SampleType, true, saturationAntiderivative>
+        }
+    };
+
+    return kernels[numChannels >= 2 ? 1 : 0][saturation];
+}
+
+template <typename SampleType>
+void FourKEQ::saturateBlock(juce::dsp::AudioBlock<SampleType>& block, juce::SmoothedValue<float>& amount,
+                            const FourKWaveshaper& curve, AntiderivativeState* antiderivative)
+{
+    // At zero the saturator is a straight wire (ADAA's delay aside)
+    if (antiderivative == nullptr && ! amount.isSmoothing() && amount.getTargetValue() <= 0.0f)
+        return;
+
+    auto numSamples = block.getNumSamples();
+    std::array<float, SmoothingEngine::controlInterval> amounts;
+
+    for (size_t position = 0; position < numSamples; position += amounts.size())
+    {
+        auto chunkLength = juce::jmin(numSamples - position, amounts.size());
+
+        for (size_t i = 0; i < chunkLength; ++i)
+            amounts[i] = amount.getNextValue();
+
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            auto* samples = block.getChannelPointer(channel) + position;
+
+            if (antiderivative != nullptr)
+                applyAntiderivativeSaturation(samples, 1, chunkLength, amounts.data(), curve,
+                                              antiderivative[channel]);
             else
+                applySaturation(samples, chunkLength, amounts.data(), curve);
+        }
+    }
+}
+
+template <typename SampleType, bool UseFrames, FourKEQ::SaturationMode Saturation>
+void FourKEQ::processChunk(std::vector<FrameChain<SampleType>>& frameChains, MonoChain<SampleType>& mono,
+                           juce::dsp::AudioBlock<SampleType>& block, size_t position, size_t length,
+                           const float* saturationAmounts, const FourKWaveshaper& curve,
+                           AntiderivativeState* antiderivative)
+{
+    // Each instantiation uses only some of these
+    juce::ignoreUnused(frameChains, mono, saturationAmounts, curve, antiderivative);
+
+    if constexpr (UseFrames)
+    {
+        using Frame = ChannelFrame<SampleType>;
+        constexpr auto numLanes = Frame::size();
+
+        auto& scratch = getEngine<SampleType>().frameScratch;
+        auto numChannels = block.getNumChannels();
+        jassert(numChannels <= frameChains.size() * numLanes);
+
+        for (size_t group = 0; group * numLanes < numChannels; ++group)
+        {
+            auto firstChannel = group * numLanes;
+            auto numGroupChannels = juce::jmin(numLanes, numChannels - firstChannel);
+
+            // A short group after a full one would pick up its leftovers in
+            // the unused lanes
+            if (group > 0 && numGroupChannels < numLanes)
+                std::fill(scratch.begin(), scratch.begin() + (std::ptrdiff_t) length, Frame::expand((SampleType) 0));
+
+            for (size_t lane = 0; lane < numGroupChannels; ++lane)
             {
-                processSample = hpfFilter.stage1.filterR.processSample(processSample);
-                processSample = hpfFilter.stage2.filterR.processSample(processSample);
+                auto* samples = block.getChannelPointer(firstChannel + lane) + position;
+
+                for (size_t i = 0; i < length; ++i)
+                    scratch[i].set(lane, samples[i]);
             }
 
-            // Apply 4-band EQ
-            if (channel == 0)
+            frameChains[group].process(scratch.data(), length);
+
+            if constexpr (Saturation == saturationAntiderivative)
             {
-                processSample = lfFilter.filter.processSample(processSample);
-                processSample = lmFilter.filter.processSample(processSample);
-                processSample = hmFilter.filter.processSample(processSample);
-                processSample = hfFilter.filter.processSample(processSample);
+                auto* samples = reinterpret_cast<SampleType*>(scratch.data());
+
+                for (size_t lane = 0; lane < numGroupChannels; ++lane)
+                    applyAntiderivativeSaturation(samples + lane, numLanes, length, saturationAmounts, curve,
+                                                  antiderivative[firstChannel + lane]);
             }
-            else
+            else if constexpr (Saturation == saturationPlain)
             {
-                processSample = lfFilter.filterR.processSample(processSample);
-                processSample = lmFilter.filterR.processSample(processSample);
-                processSample = hmFilter.filterR.processSample(processSample);
-                processSample = hfFilter.filterR.processSample(processSample);
+                applySaturation(scratch.data(), length, saturationAmounts, curve);
             }
 
-            // Apply LPF
-            if (channel == 0)
-                processSample = lpfFilter.filter.processSample(processSample);
-            else
-                processSample = lpfFilter.filterR.processSample(processSample);
+            for (size_t lane = 0; lane < numGroupChannels; ++lane)
+            {
+                auto* samples = block.getChannelPointer(firstChannel + lane) + position;
+
+                for (size_t i = 0; i < length; ++i)
+                    samples[i] = scratch[i].get(lane);
+            }
+        }
+    }
+    else
+    {
+        auto* samples = block.getChannelPointer(0) + position;
+
+        mono.process(samples, length);
+
+        if constexpr (Saturation == saturationAntiderivative)
+            applyAntiderivativeSaturation(samples, 1, length, saturationAmounts, curve, antiderivative[0]);
+        else if constexpr (Saturation == saturationPlain)
+            applySaturation(samples, length, saturationAmounts, curve);
+    }
+}
+
+template <typename SampleType>
+void FourKEQ::processFadingPath(const juce::dsp::AudioBlock<SampleType>& input)
+{
+    // The outgoing path works on its own copy of the input; its coefficients
+    // and saturation stay frozen for the short time it is audible
+    auto& engine = getEngine<SampleType>();
+    auto fadeBlock = juce::dsp::AudioBlock<SampleType>(engine.crossfadeBuffer).getSubBlock(0, input.getNumSamples());
+    fadeBlock.copyFrom(input);
+
+    auto& outgoing = *fadingPath.path;
+    auto& processor = outgoing.get<SampleType>();
+
+    juce::SmoothedValue<float> saturation;
+    saturation.setCurrentAndTargetValue(fadingPath.saturation);
+
+    std::array<float, SmoothingEngine::controlInterval> saturationAmounts;
+    saturationAmounts.fill(fadingPath.saturation);
+
+    const auto& curve = FourKWaveshaper::get(outgoing.config.curve);
+    auto* antiderivative = outgoing.config.antiderivative ? fadingPath.antiderivativeStates.data() : nullptr;
+
+    auto mode = antiderivative != nullptr ? saturationAntiderivative
+              : fadingPath.saturation > 0.0f ? saturationPlain
+              : saturationOff;
+
+    auto filter = [&] (juce::dsp::AudioBlock<SampleType>& block, SaturationMode blockMode)
+    {
+        const auto kernel = getChunkKernel<SampleType>(block.getNumChannels(), blockMode);
+        auto numSamples = block.getNumSamples();
+
+        for (size_t position = 0; position < numSamples; position += SmoothingEngine::controlInterval)
+        {
+            auto chunkLength = juce::jmin(numSamples - position, (size_t) SmoothingEngine::controlInterval);
+            (this->*kernel)(engine.fadingFrameChains, engine.fadingMonoChain, block, position, chunkLength,
+                            saturationAmounts.data(), curve, antiderivative);
+        }
+    };
+
+    if (processor.oversampler == nullptr)
+    {
+        filter(fadeBlock, outgoing.config.linear ? saturationOff : mode);
+
+        if (outgoing.config.linear)
+            delayBlock(fadeBlock, processor.latencyDelay);
+    }
+    else if (outgoing.config.saturatorOnly)
+    {
+        filter(fadeBlock, saturationOff);
+
+        auto oversampledBlock = processor.oversampler->processSamplesUp(fadeBlock);
+        saturateBlock(oversampledBlock, saturation, curve, antiderivative);
+
+        if (outgoing.padding > 0.0f)
+            delayBlock(oversampledBlock, processor.padDelay);
+
+        processor.oversampler->processSamplesDown(fadeBlock);
+    }
+    else
+    {
+        auto oversampledBlock = processor.oversampler->processSamplesUp(fadeBlock);
+        filter(oversampledBlock, mode);
+
+        if (outgoing.padding > 0.0f)
+            delayBlock(oversampledBlock, processor.padDelay);
+
+        processor.oversampler->processSamplesDown(fadeBlock);
+    }
+}
+
+template <typename SampleType, typename InterpolationType>
+void FourKEQ::delayBlock(juce::dsp::AudioBlock<SampleType>& block,
+                         juce::dsp::DelayLine<SampleType, InterpolationType>& delay)
+{
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* samples = block.getChannelPointer(channel);
+
+        for (size_t i = 0; i < block.getNumSamples(); ++i)
+        {
+            delay.pushSample((int) channel, samples[i]);
+            samples[i] = delay.popSample((int) channel);
+        }
+    }
+}
+
+template <typename SampleType>
+void FourKEQ::mixInFadingPath(juce::dsp::AudioBlock<SampleType>& block)
+{
+    // Linear fade: both paths carry the same, correlated signal
+    auto& crossfadeBuffer = getEngine<SampleType>().crossfadeBuffer;
+    auto fadeSamples = juce::jmin((int) block.getNumSamples(), crossfadeSamplesRemaining);
 
-            // Apply saturation in the oversampled domain
-            float satAmount = saturationParam->load() * 0.01f;
-            if (satAmount > 0.0f)
-                processSample = applySaturation(processSample, satAmount);
+    for (int channel = 0; channel < preparedNumChannels; ++channel)
+    {
+        auto* output = block.getChannelPointer((size_t) channel);
+        auto* outgoing = crossfadeBuffer.getReadPointer(channel);
 
-            channelData[sample] = processSample;
+        for (int i = 0; i < fadeSamples; ++i)
+        {
+            auto incomingGain = 1 - (SampleType) (crossfadeSamplesRemaining - i) / (SampleType) crossfadeLength;
+            output[i] = outgoing[i] + incomingGain * (output[i] - outgoing[i]);
         }
     }
 
-    // Downsample back to original rate
-    oversampler.processSamplesDown(block);
+    crossfadeSamplesRemaining -= fadeSamples;
+}
+
+//==============================================================================
+int FourKEQ::useTimeSlice()
+{
+    const juce::SpinLock::ScopedLockType lock(designLock);
+    runDesigner();
+
+    return designerIntervalMs;
+}
+
+void FourKEQ::runDesigner()
+{
+    auto params = readParameters();
+    auto incoming = updatePath(params);
+    updateFilters(params);
+
+    // Coefficients for the new path are published before the path itself,
+    // so processBlock never switches to a rate it has nothing designed for
+    if (incoming != nullptr)
+    {
+        auto latencySamples = incoming->latency;
+        pendingPath.store(incoming.release(), std::memory_order_release);
+
+        if (latencySamples != pendingLatencySamples.exchange(latencySamples))
+            triggerAsyncUpdate();
+    }
+}
+
+void FourKEQ::handleAsyncUpdate()
+{
+    setLatencySamples(pendingLatencySamples.load());
+}
+
+FourKEQ::ParameterSnapshot FourKEQ::readParameters() const noexcept
+{
+    ParameterSnapshot params;
+
+    params.hpfFreq = hpfFreqParam->load();
+    params.lpfFreq = lpfFreqParam->load();
+
+    params.lfGain = lfGainParam->load();
+    params.lfFreq = lfFreqParam->load();
+    params.lfBell = lfBellParam->load() > 0.5f;
+
+    params.lmGain = lmGainParam->load();
+    params.lmFreq = lmFreqParam->load();
+    params.lmQ = lmQParam->load();
+
+    params.hmGain = hmGainParam->load();
+    params.hmFreq = hmFreqParam->load();
+    params.hmQ = hmQParam->load();
+
+    params.hfGain = hfGainParam->load();
+    params.hfFreq = hfFreqParam->load();
+    params.hfBell = hfBellParam->load() > 0.5f;
+
+    params.isBlack = eqTypeParam->load() > 0.5f;
+    params.bypass = bypassParam->load() > 0.5f;
+    params.outputGain = juce::Decibels::decibelsToGain(outputGainParam->load());
+    params.saturation = saturationParam->load() * 0.01f;
+    params.oversamplingChoice = juce::roundToInt(oversamplingParam->load());
+    params.saturatorOnly = oversamplingModeParam->load() > 0.5f;
+    params.linearPhase = oversamplingFilterParam->load() > 0.5f;
+    params.antiderivative = saturationAntialiasParam->load() > 0.5f;
+    params.saturationCurve = juce::roundToInt(saturationCurveParam->load());
+    params.renderOversampling = juce::roundToInt(renderOversamplingParam->load());
+
+    return params;
+}
+
+FourKEQ::OversamplingConfig FourKEQ::getRequestedConfig(const ParameterSnapshot& params) const
+{
+    OversamplingConfig config;
+    int choice = params.oversamplingChoice;
+
+    config.factor = choice == autoOversamplingChoice ? getAutoOversamplingFactor(currentSampleRate)
+                                                     : 1 << juce::jlimit(0, maxOversamplingStages, choice);
+    config.filterType = params.linearPhase ? FourKOversamplerBase::filterLinearPhaseFIR
+                                           : FourKOversamplerBase::filterPolyphaseIIR;
+    config.curve = (FourKWaveshaper::Curve) juce::jlimit(0, FourKWaveshaper::numCurves - 1, params.saturationCurve);
+
+    // Bounces run at the render factor, if that's higher, with the whole
+    // chain oversampled and the saturator always in, so the rendered result
+    // doesn't depend on when the designer thread catches up with automation.
+    // The path, and with it the latency, is settled in prepareToPlay
+    int renderSetting = params.renderOversampling;
+    bool rendering = preparedNonRealtime && renderSetting > 0;
+
+    if (rendering)
+        config.factor = juce::jmax(config.factor, 1 << (renderSetting + 1));
+
+    // ADAA's two-sample average is a cos(pi f / fs) low-pass on everything
+    // the saturator passes: -16.7 dB at 20 kHz at 44.1 kHz, -2.4 dB at 2x.
+    // At the host rate that would take the top octave with it, so it only
+    // runs on an oversampled saturator.
+    config.antiderivative = params.antiderivative && config.factor > 1;
+
+    if (rendering)
+        return config;
+
+    // At 1x everything already runs at the host rate, and with the
+    // saturator off the mode makes no difference. A plain 1x path has
+    // nothing to drop when the saturator goes off.
+    if (config.factor == 1)
+        config.filterType = FourKOversamplerBase::filterPolyphaseIIR;
+
+    if (params.saturation <= 0.0f)
+        config.linear = config.factor > 1;
+    else
+        config.saturatorOnly = (config.factor > 1 && params.saturatorOnly);
+
+    // A linear path never saturates, so changing the curve or ADAA under it
+    // must not swap it for an identical one
+    if (config.linear)
+    {
+        config.curve = FourKWaveshaper::curveTanh;
+        config.antiderivative = false;
+    }
+
+    return config;
+}
+
+std::unique_ptr<FourKEQ::OversamplingPath> FourKEQ::createPath(const OversamplingConfig& config) const
+{
+    auto newPath = std::make_unique<OversamplingPath>();
+    newPath->config = config;
+
+    // A linear path matches the latency of the oversampler it replaces. It
+    // has no saturator, so none of ADAA's: with ADAA on, turning saturation
+    // up from 0 can add a sample of latency (min phase 2x)
+    float latency = config.getSaturatorLatency();
+
+    if (config.factor > 1)
+        latency += getOversamplerLatency(config.factor, config.filterType);
+
+    // Rounded up to whole host samples; an oversampled path pads the
+    // difference at its own rate
+    newPath->latency = (int) std::ceil(latency - latencyTolerance);
+
+    if (config.factor > 1 && ! config.linear)
+        newPath->padding = juce::jmax(0.0f, ((float) newPath->latency - latency) * (float) config.factor);
+
+    if (preparedDoublePrecision)
+        preparePathProcessor<double>(*newPath);
+    else
+        preparePathProcessor<float>(*newPath);
+
+    return newPath;
+}
+
+template <typename SampleType>
+void FourKEQ::preparePathProcessor(OversamplingPath& newPath) const
+{
+    auto& config = newPath.config;
+    auto& processor = newPath.get<SampleType>();
+
+    if (config.factor > 1 && ! config.linear)
+    {
+        processor.oversampler = createOversampler<SampleType>(config.factor, config.filterType,
+                                                              (size_t) preparedNumChannels);
+        processor.oversampler->initProcessing((size_t) subBlockSize);
+        jassert(processor.oversampler->getLatencyInSamples() == getOversamplerLatency(config.factor, config.filterType));
+
+        processor.padDelay.setMaximumDelayInSamples((int) std::ceil(newPath.padding) + 4);
+        processor.padDelay.prepare({ currentSampleRate * config.factor, (juce::uint32) (subBlockSize * config.factor),
+                                     (juce::uint32) preparedNumChannels });
+        processor.padDelay.setDelay((SampleType) newPath.padding);
+    }
+
+    if (! config.linear)
+        return;
+
+    processor.latencyDelay.setMaximumDelayInSamples(newPath.latency + 4);
+    processor.latencyDelay.prepare({ currentSampleRate, (juce::uint32) subBlockSize,
+                                     (juce::uint32) preparedNumChannels });
+    processor.latencyDelay.setDelay((SampleType) newPath.latency);
+}
+
+int FourKEQ::getNumOversamplingStages(int factor)
+{
+    int stages = 0;
+
+    while ((1 << stages) < factor)
+        ++stages;
+
+    return stages;
+}
+
+int FourKEQ::getAutoOversamplingFactor(double sampleRate)
+{
+    int factor = 1;
+
+    while (factor < (1 << maxOversamplingStages) && sampleRate * factor < autoMinimumRate)
+        factor *= 2;
+
+    return factor;
+}
+
+template <typename SampleType>
+std::unique_ptr<FourKEQ::Oversampler<SampleType>> FourKEQ::createOversampler(int factor, OversamplingFilter filterType,
+                                                                             size_t numChannels)
+{
+    return std::make_unique<Oversampler<SampleType>>(numChannels, (size_t) getNumOversamplingStages(factor),
+                                                     filterType, oversamplingStopbandDb);
+}
+
+float FourKEQ::getOversamplerLatency(int factor, OversamplingFilter filterType)
+{
+    // Depends only on the factor and filter type, not the precision; measured
+    // once per process on single-channel oversamplers that are thrown away
+    // straight after
+    static const auto latencies = []
+    {
+        std::array<std::array<float, maxOversamplingStages + 1>, 2> result {};
+
+        for (auto type : { FourKOversamplerBase::filterPolyphaseIIR, FourKOversamplerBase::filterLinearPhaseFIR })
+            for (int stages = 1; stages <= maxOversamplingStages; ++stages)
+                result[(size_t) type][(size_t) stages] = createOversampler<float>(1 << stages, type, 1)
+                                                             ->getLatencyInSamples();
+
+        return result;
+    }();
+
+    return latencies[(size_t) filterType][(size_t) getNumOversamplingStages(factor)];
+}
+
+std::unique_ptr<FourKEQ::OversamplingPath> FourKEQ::updatePath(const ParameterSnapshot& params)
+{
+    // Free whatever processBlock handed back since the last slice
+    delete retiredPath.exchange(nullptr, std::memory_order_acquire);
+
+    auto config = getRequestedConfig(params);
+
+    if (config == designedConfig)
+        return {};
+
+    // Only one switch in flight at a time: wait until processBlock has taken
+    // the previous one
+    if (pendingPath.load(std::memory_order_acquire) != nullptr)
+        return {};
+
+    designedConfig = config;
+
+    // Everything from here on is designed for the new filter rate
+    invalidateDesigns();
+    return createPath(config);
+}
+
+template <typename SampleType>
+void FourKEQ::adoptPendingPath()
+{
+    // Wait until the previous switch has faded out and been handed back
+    if (fadingPath.path != nullptr)
+        return;
+
+    auto* incoming = pendingPath.load(std::memory_order_acquire);
+
+    if (incoming == nullptr)
+        return;
+
+    // Let the saturator ramp out before dropping the oversampler
+    if (incoming->config.linear && smoothing.saturation.isSmoothing())
+        return;
+
+    pendingPath.store(nullptr, std::memory_order_relaxed);
+
+    // The outgoing path keeps its coefficients and filter state and fades
+    // out; the live chains carry the same state into the new rate and take
+    // the set designed for it straight away
+    auto& engine = getEngine<SampleType>();
+
+    fadingPath.path = std::move(path);
+    std::copy(engine.frameChains.begin(), engine.frameChains.end(), engine.fadingFrameChains.begin());
+    engine.fadingMonoChain = engine.monoChain;
+    fadingPath.saturation = smoothing.saturation.getCurrentValue();
+    fadingPath.antiderivativeStates = antiderivativeStates;
+
+    path.reset(incoming);
+    dcBlockerMix.setTargetValue(path->config.needsDcBlocker() ? 1.0f : 0.0f);
+    oversampledRate = currentSampleRate * (path->config.linear ? 1 : path->config.factor);
+    if (path->latency != dryDelay)
+    {
+        previousDryDelay = dryDelay;
+        dryDelay = path->latency;
+        dryDelayFade.setCurrentAndTargetValue(0.0f);
+        dryDelayFade.setTargetValue(1.0f);
+    }
+
+    smoothing.setRates(currentSampleRate * path->config.getFilterFactor(), currentSampleRate * path->config.factor);
+    smoothing.saturation.setCurrentAndTargetValue(fadingPath.saturation);
+
+    if (hasHeldCoefficients)
+        receiveCoefficients(heldCoefficients);
+
+    if (coefficientHandoff.acquire())
+        receiveCoefficients(coefficientHandoff.getReadBuffer());
+
+    jassert(smoothing.target.filterFactor == path->config.getFilterFactor());
+
+    smoothing.snapToTarget();
+    applyCoefficients<SampleType>(smoothing.current);
+    smoothing.samplesUntilTick = 0;
+
+    crossfadeSamplesRemaining = crossfadeLength;
+}
+
+void FourKEQ::retireFadingPath()
+{
+    if (fadingPath.path == nullptr || crossfadeSamplesRemaining > 0)
+        return;
+
+    // Hand the outgoing path to the designer thread to free; if the previous
+    // one hasn't been collected yet, try again next block
+    OversamplingPath* expected = nullptr;
+
+    if (retiredPath.compare_exchange_strong(expected, fadingPath.path.get(), std::memory_order_release))
+        fadingPath.path.release();
+}
+
+void FourKEQ::receiveCoefficients(const CoefficientSet& set)
+{
+    if (set.filterFactor == path->config.getFilterFactor())
+    {
+        smoothing.setTarget(set);
+        hasHeldCoefficients = false;
+        return;
+    }
+
+    // Designed for a path processBlock hasn't switched to yet
+    heldCoefficients = set;
+    hasHeldCoefficients = true;
+}
+
+void FourKEQ::freeSparePaths()
+{
+    delete pendingPath.exchange(nullptr);
+    delete retiredPath.exchange(nullptr);
+}
+
+void FourKEQ::invalidateDesigns()
+{
+    hpfInputs.invalidate();
+    lpfInputs.invalidate();
+    lfInputs.invalidate();
+    lmInputs.invalidate();
+    hmInputs.invalidate();
+    hfInputs.invalidate();
+}
+
+template <typename SampleType>
+void FourKEQ::applyCoefficients(const CoefficientSet& set)
+{
+    auto& engine = getEngine<SampleType>();
+
+    for (auto& chain : engine.frameChains)
+    {
+        chain.setFirstOrderCoefficients(set.hpfFirstOrder);
+
+        for (size_t section = 0; section < set.sections.size(); ++section)
+            chain.setCoefficients(section, set.sections[section]);
+    }
+
+    engine.monoChain.setFirstOrderCoefficients(set.hpfFirstOrder);
 
-    // Apply output gain
-    float outputGainValue = outputGainParam->load();
-    float outputGain = juce::Decibels::decibelsToGain(outputGainValue);
-    buffer.applyGain(outputGain);
+    for (size_t section = 0; section < set.sections.size(); ++section)
+        engine.monoChain.setCoefficients(section, set.sections[section]);
+}
+
+FourKEQ::Biquad FourKEQ::normalise(const std::array<double, 6>& coefficients)
+{
+    const double a0Inv = 1.0 / coefficients[3];
+
+    return { coefficients[0] * a0Inv, coefficients[1] * a0Inv, coefficients[2] * a0Inv,
+             coefficients[4] * a0Inv, coefficients[5] * a0Inv };
+}
+
+FourKEQ::FirstOrder FourKEQ::normalise(const std::array<double, 4>& coefficients)
+{
+    const double a0Inv = 1.0 / coefficients[2];
+
+    return { coefficients[0] * a0Inv, coefficients[1] * a0Inv, coefficients[3] * a0Inv };
+}
+
+FourKEQ::Biquad FourKEQ::designHighPass(double sampleRate, float freq, float q) const
+{
+    if (designedConfig.getFilterFactor() == 1)
+        return normalise(FourKMatchedCoefficients::makeHighPass(sampleRate, freq, q));
+
+    return normalise(juce::dsp::IIR::ArrayCoefficients<double>::makeHighPass(sampleRate, freq, q));
+}
+
+FourKEQ::Biquad FourKEQ::designLowPass(double sampleRate, float freq, float q) const
+{
+    if (designedConfig.getFilterFactor() == 1)
+        return normalise(FourKMatchedCoefficients::makeLowPass(sampleRate, freq, q));
+
+    return normalise(juce::dsp::IIR::ArrayCoefficients<double>::makeLowPass(sampleRate, freq, q));
+}
+
+FourKEQ::Biquad FourKEQ::designPeakFilter(double sampleRate, float freq, float q, float gainFactor) const
+{
+    if (designedConfig.getFilterFactor() == 1)
+        return normalise(FourKMatchedCoefficients::makePeakFilter(sampleRate, freq, q, gainFactor));
+
+    return normalise(juce::dsp::IIR::ArrayCoefficients<double>::makePeakFilter(sampleRate, freq, q, gainFactor));
+}
+
+FourKEQ::Biquad FourKEQ::designLowShelf(double sampleRate, float freq, float q, float gainFactor) const
+{
+    if (designedConfig.getFilterFactor() == 1)
+        return normalise(FourKMatchedCoefficients::makeLowShelf(sampleRate, freq, q, gainFactor));
+
+    return normalise(juce::dsp::IIR::ArrayCoefficients<double>::makeLowShelf(sampleRate, freq, q, gainFactor));
+}
+
+FourKEQ::Biquad FourKEQ::designHighShelf(double sampleRate, float freq, float q, float gainFactor) const
+{
+    if (designedConfig.getFilterFactor() == 1)
+        return normalise(FourKMatchedCoefficients::makeHighShelf(sampleRate, freq, q, gainFactor));
+
+    return normalise(juce::dsp::IIR::ArrayCoefficients<double>::makeHighShelf(sampleRate, freq, q, gainFactor));
+}
+
+FourKEQ::FirstOrder FourKEQ::designFirstOrderHighPass(double sampleRate, float freq) const
+{
+    if (designedConfig.getFilterFactor() == 1)
+        return normalise(FourKMatchedCoefficients::makeFirstOrderHighPass(sampleRate, freq));
+
+    return normalise(juce::dsp::IIR::ArrayCoefficients<double>::makeFirstOrderHighPass(sampleRate, freq));
 }
 
 //==============================================================================
-void FourKEQ::updateFilters()
+void FourKEQ::SmoothingEngine::setRates(double newFilterRate, double newSaturationRate)
 {
-    double oversampledRate = currentSampleRate * oversamplingFactor;
+    if (newFilterRate != filterRate)
+    {
+        filterRate = newFilterRate;
+        glide = (1.0 - std::exp(-controlInterval / (glideTimeSeconds * newFilterRate)));
+    }
+
+    if (newSaturationRate != saturationRate)
+    {
+        saturationRate = newSaturationRate;
+        saturation.reset(newSaturationRate, 0.02);
+    }
+}
+
+void FourKEQ::SmoothingEngine::setTarget(const CoefficientSet& newTarget)
+{
+    target = newTarget;
+    settled = false;
+}
 
-    updateHPF(oversampledRate);
-    updateLPF(oversampledRate);
-    updateLFBand(oversampledRate);
-    updateLMBand(oversampledRate);
-    updateHMBand(oversampledRate);
-    updateHFBand(oversampledRate);
+void FourKEQ::SmoothingEngine::snapToTarget()
+{
+    current = target;
+    settled = true;
 }
 
-void FourKEQ::updateHPF(double sampleRate)
+bool FourKEQ::SmoothingEngine::tick()
 {
-    float freq = hpfFreqParam->load();
+    if (settled)
+        return false;
+
+    // Each step is a convex blend of two stable designs. The biquad stability
+    // triangle (and |a1| < 1 for the first-order section) is convex, so every
+    // intermediate filter is stable too.
+    double maxDistance = 0.0;
+
+    auto glideTowards = [&] (double& value, double targetValue)
+    {
+        auto distance = targetValue - value;
+        value += glide * distance;
+        maxDistance = juce::jmax(maxDistance, std::abs(distance));
+    };
+
+    for (size_t i = 0; i < current.hpfFirstOrder.size(); ++i)
+        glideTowards(current.hpfFirstOrder[i], target.hpfFirstOrder[i]);
+
+    for (size_t section = 0; section < current.sections.size(); ++section)
+        for (size_t i = 0; i < current.sections[section].size(); ++i)
+            glideTowards(current.sections[section][i], target.sections[section][i]);
 
-    // Create coefficients for a Butterworth HPF
-    // Use two cascaded 2nd order filters for ~18dB/oct
-    auto coeffs1 = juce::dsp::IIR::Coefficients<float>::makeHighPass(
-        sampleRate, freq, 0.54f);  // Q for Butterworth cascade
-    auto coeffs2 = juce::dsp::IIR::Coefficients<float>::makeHighPass(
-        sampleRate, freq, 1.31f);  // Q for Butterworth cascade
+    if (maxDistance < settleThreshold)
+        snapToTarget();
 
-    hpfFilter.stage1.filter.coefficients = coeffs1;
-    hpfFilter.stage1.filterR.coefficients = coeffs1;
-    hpfFilter.stage2.filter.coefficients = coeffs2;
-    hpfFilter.stage2.filterR.coefficients = coeffs2;
+    return true;
+}
+
+bool FourKEQ::updateFilters(const ParameterSnapshot& params)
+{
+    // Design for the newest path built, which processBlock switches to at
+    // its next block boundary
+    double filterRate = currentSampleRate * designedConfig.getFilterFactor();
+
+    bool changed = updateHPF(filterRate, params);
+    changed |= updateLPF(filterRate, params);
+    changed |= updateLFBand(filterRate, params);
+    changed |= updateLMBand(filterRate, params);
+    changed |= updateHMBand(filterRate, params);
+    changed |= updateHFBand(filterRate, params);
+
+    if (changed)
+    {
+        designedCoefficients.filterFactor = designedConfig.getFilterFactor();
+        coefficientHandoff.getWriteBuffer() = designedCoefficients;
+        coefficientHandoff.publish();
+    }
+
+    return changed;
 }
 
-void FourKEQ::updateLPF(double sampleRate)
+bool FourKEQ::updateHPF(double sampleRate, const ParameterSnapshot& params)
 {
-    float freq = lpfFreqParam->load();
+    float freq = params.hpfFreq;
+
+    if (! hpfInputs.changed({ freq, 0.0f, 0.0f, 0.0f, (float) sampleRate }))
+        return false;
+
+    if (freq <= hpfParkedFrequency)
+    {
+        // Parked at the bottom of its range: HPF out
+        designedCoefficients.hpfFirstOrder = MonoChain<double>::firstOrderIdentity;
+        designedCoefficients.sections[hpfSection] = MonoChain<double>::identity;
+        return true;
+    }
+
+    // 3rd order Butterworth HPF (18dB/oct): a first-order section at the
+    // cutoff followed by a biquad with the Butterworth pole pair (Q = 1)
+    designedCoefficients.hpfFirstOrder = designFirstOrderHighPass(sampleRate, freq);
+    designedCoefficients.sections[hpfSection] = designHighPass(
+        sampleRate, freq, 1.0f);
+
+    return true;
+}
+
+bool FourKEQ::updateLPF(double sampleRate, const ParameterSnapshot& params)
+{
+    float freq = params.lpfFreq;
+
+    if (! lpfInputs.changed({ freq, 0.0f, 0.0f, 0.0f, (float) sampleRate }))
+        return false;
+
+    if (freq >= lpfParkedFrequency)
+    {
+        // Parked at the top of its range: LPF out
+        designedCoefficients.sections[lpfSection] = MonoChain<double>::identity;
+        return true;
+    }
 
     // 12dB/oct Butterworth LPF
-    auto coeffs = juce::dsp::IIR::Coefficients<float>::makeLowPass(
+    designedCoefficients.sections[lpfSection] = designLowPass(
         sampleRate, freq, 0.707f);
 
-    lpfFilter.filter.coefficients = coeffs;
-    lpfFilter.filterR.coefficients = coeffs;
+    return true;
 }
 
-void FourKEQ::updateLFBand(double sampleRate)
+bool FourKEQ::updateLFBand(double sampleRate, const ParameterSnapshot& params)
 {
-    float gain = lfGainParam->load();
-    float freq = lfFreqParam->load();
-    bool isBlack = (eqTypeParam->load() > 0.5f);
-    bool isBell = (lfBellParam->load() > 0.5f);
+    float gain = params.lfGain;
+    float freq = params.lfFreq;
+    bool isBlack = params.isBlack;
+    bool isBell = params.lfBell;
 
-    if (isBlack && isBell)
+    if (! lfInputs.changed({ freq, gain, isBlack ? 1.0f : 0.0f, isBell ? 1.0f : 0.0f, (float) sampleRate }))
+        return false;
+
+    if (std::abs(gain) < flatGainThresholdDb)
+    {
+        // Flat in either mode
+        designedCoefficients.sections[lfSection] = MonoChain<double>::identity;
+    }
+    else if (isBlack && isBell)
     {
         // Bell mode in Black variant
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makePeakFilter(
+        designedCoefficients.sections[lfSection] = designPeakFilter(
             sampleRate, freq, 0.7f, juce::Decibels::decibelsToGain(gain));
-        lfFilter.filter.coefficients = coeffs;
-        lfFilter.filterR.coefficients = coeffs;
     }
     else
     {
         // Shelf mode
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makeLowShelf(
+        designedCoefficients.sections[lfSection] = designLowShelf(
             sampleRate, freq, 0.7f, juce::Decibels::decibelsToGain(gain));
-        lfFilter.filter.coefficients = coeffs;
-        lfFilter.filterR.coefficients = coeffs;
     }
+
+    return true;
 }
 
-void FourKEQ::updateLMBand(double sampleRate)
+bool FourKEQ::updateLMBand(double sampleRate, const ParameterSnapshot& params)
 {
-    float gain = lmGainParam->load();
-    float freq = lmFreqParam->load();
-    float q = lmQParam->load();
-    bool isBlack = (eqTypeParam->load() > 0.5f);
+    float gain = params.lmGain;
+    float freq = params.lmFreq;
+    float q = params.lmQ;
+    bool isBlack = params.isBlack;
+
+    if (! lmInputs.changed({ freq, gain, q, isBlack ? 1.0f : 0.0f, (float) sampleRate }))
+        return false;
+
+    if (std::abs(gain) < flatGainThresholdDb)
+    {
+        designedCoefficients.sections[lmSection] = MonoChain<double>::identity;
+        return true;
+    }
 
     // Dynamic Q in Black mode
     if (isBlack)
         q = calculateDynamicQ(gain, q);
 
-    auto coeffs = juce::dsp::IIR::Coefficients<float>::makePeakFilter(
+    designedCoefficients.sections[lmSection] = designPeakFilter(
         sampleRate, freq, q, juce::Decibels::decibelsToGain(gain));
 
-    lmFilter.filter.coefficients = coeffs;
-    lmFilter.filterR.coefficients = coeffs;
+    return true;
 }
 
-void FourKEQ::updateHMBand(double sampleRate)
+bool FourKEQ::updateHMBand(double sampleRate, const ParameterSnapshot& params)
 {
-    float gain = hmGainParam->load();
-    float freq = hmFreqParam->load();
-    float q = hmQParam->load();
-    bool isBlack = (eqTypeParam->load() > 0.5f);
+    float gain = params.hmGain;
+    float freq = params.hmFreq;
+    float q = params.hmQ;
+    bool isBlack = params.isBlack;
+
+    if (! hmInputs.changed({ freq, gain, q, isBlack ? 1.0f : 0.0f, (float) sampleRate }))
+        return false;
+
+    if (std::abs(gain) < flatGainThresholdDb)
+    {
+        designedCoefficients.sections[hmSection] = MonoChain<double>::identity;
+        return true;
+    }
 
     // Dynamic Q in Black mode
     if (isBlack)
         q = calculateDynamicQ(gain, q);
 
-    auto coeffs = juce::dsp::IIR::Coefficients<float>::makePeakFilter(
+    designedCoefficients.sections[hmSection] = designPeakFilter(
         sampleRate, freq, q, juce::Decibels::decibelsToGain(gain));
 
-    hmFilter.filter.coefficients = coeffs;
-    hmFilter.filterR.coefficients = coeffs;
+    return true;
 }
 
-void FourKEQ::updateHFBand(double sampleRate)
+bool FourKEQ::updateHFBand(double sampleRate, const ParameterSnapshot& params)
 {
-    float gain = hfGainParam->load();
-    float freq = hfFreqParam->load();
-    bool isBlack = (eqTypeParam->load() > 0.5f);
-    bool isBell = (hfBellParam->load() > 0.5f);
+    float gain = params.hfGain;
+    float freq = params.hfFreq;
+    bool isBlack = params.isBlack;
+    bool isBell = params.hfBell;
+
+    if (! hfInputs.changed({ freq, gain, isBlack ? 1.0f : 0.0f, isBell ? 1.0f : 0.0f, (float) sampleRate }))
+        return false;
 
-    if (isBlack && isBell)
+    if (std::abs(gain) < flatGainThresholdDb)
+    {
+        // Flat in either mode
+        designedCoefficients.sections[hfSection] = MonoChain<double>::identity;
+    }
+    else if (isBlack && isBell)
     {
         // Bell mode in Black variant
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makePeakFilter(
+        designedCoefficients.sections[hfSection] = designPeakFilter(
             sampleRate, freq, 0.7f, juce::Decibels::decibelsToGain(gain));
-        hfFilter.filter.coefficients = coeffs;
-        hfFilter.filterR.coefficients = coeffs;
     }
     else
     {
         // Shelf mode
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makeHighShelf(
+        designedCoefficients.sections[hfSection] = designHighShelf(
             sampleRate, freq, 0.7f, juce::Decibels::decibelsToGain(gain));
-        hfFilter.filter.coefficients = coeffs;
-        hfFilter.filterR.coefficients = coeffs;
     }
+
+    return true;
 }
 
 float FourKEQ::calculateDynamicQ(float gain, float baseQ) const
@@ -421,21 +1559,90 @@ float FourKEQ::calculateDynamicQ(float gain, float baseQ) const
     return juce::jlimit(0.5f, 5.0f, dynamicQ);
 }
 
-float FourKEQ::applySaturation(float sample, float amount) const
+template <typename SampleType>
+SampleType FourKEQ::applySaturation(SampleType sample, float amount, const FourKWaveshaper& curve) noexcept
 {
-    // Soft saturation using tanh
+    // Soft saturation through the selected curve
     // Scale input to control saturation amount
-    float drive = 1.0f + amount * 2.0f;
-    float saturated = std::tanh(sample * drive);
+    auto wet = (SampleType) amount;
+    auto drive = 1 + wet * 2;
+    auto saturated = curve.process(sample * drive);
 
     // Mix dry and wet signals
-    return sample * (1.0f - amount) + saturated * amount;
+    return sample * (1 - wet) + saturated * wet;
+}
+
+template <typename SampleType>
+void FourKEQ::applySaturation(SampleType* samples, size_t numSamples, const float* amounts,
+                              const FourKWaveshaper& curve) noexcept
+{
+    for (size_t i = 0; i < numSamples; ++i)
+        samples[i] = applySaturation(samples[i], amounts[i], curve);
+}
+
+template <typename SampleType>
+void FourKEQ::applyAntiderivativeSaturation(SampleType* samples, size_t stride, size_t numSamples,
+                                            const float* amounts, const FourKWaveshaper& curve,
+                                            AntiderivativeState& state) noexcept
+{
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        auto& sample = samples[i * stride];
+        const double input = sample;
+        const float amount = amounts[i];
+
+        // Both ends of the quotient use the same curve
+        if (amount != state.previousAmount || &curve != state.previousCurve)
+        {
+            state.previousIntegral = getSaturationIntegral(state.previousInput, amount, curve);
+            state.previousAmount = amount;
+            state.previousCurve = &curve;
+        }
+
+        const double integral = getSaturationIntegral(input, amount, curve);
+        const double step = input - state.previousInput;
+
+        if (std::abs(step) > antiderivativeMinimumStep)
+            sample = (SampleType) ((integral - state.previousIntegral) / step);
+        else
+            sample = applySaturation((SampleType) (0.5 * (input + state.previousInput)), amount, curve);
+
+        state.previousInput = input;
+        state.previousIntegral = integral;
+    }
+}
+
+double FourKEQ::getSaturationIntegral(double sample, float amount, const FourKWaveshaper& curve) noexcept
+{
+    // Antiderivative of applySaturation(): x^2 (1 - a) / 2 + a C(d x) / d,
+    // where C is the curve's own integral. Double precision, because the
+    // quotient divides its rounding error by the step between samples.
+    const double drive = 1.0 + amount * 2.0;
+
+    return 0.5 * (1.0 - amount) * sample * sample + amount * curve.getIntegral(sample * drive) / drive;
+}
+
+template <typename SampleType>
+void FourKEQ::applySaturation(ChannelFrame<SampleType>* frames, size_t numFrames, const float* amounts,
+                              const FourKWaveshaper& curve) noexcept
+{
+    // Every lane goes through; the unused ones hold zeros, which stay zero
+    using Frame = ChannelFrame<SampleType>;
+    static_assert(sizeof(Frame) == Frame::size() * sizeof(SampleType), "Frames must be packed samples");
+
+    auto* samples = reinterpret_cast<SampleType*>(frames);
+    constexpr auto numLanes = Frame::size();
+
+    for (size_t i = 0; i < numFrames; ++i)
+        for (size_t lane = 0; lane < numLanes; ++lane)
+            samples[i * numLanes + lane] = applySaturation(samples[i * numLanes + lane], amounts[i], curve);
 }
 
 //==============================================================================
 void FourKEQ::getStateInformation(juce::MemoryBlock& destData)
 {
     auto state = parameters.copyState();
+    state.setProperty("stateVersion", currentStateVersion, nullptr);
     std::unique_ptr<juce::XmlElement> xml(state.createXml());
     copyXmlToBinary(*xml, destData);
 }
@@ -444,9 +1651,25 @@ void FourKEQ::setStateInformation(const void* data, int sizeInBytes)
 {
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
 
-    if (xmlState.get() != nullptr)
-        if (xmlState->hasTagName(parameters.state.getType()))
-            parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
+    if (xmlState.get() == nullptr || ! xmlState->hasTagName(parameters.state.getType()))
+        return;
+
+    if (xmlState->getIntAttribute("stateVersion", 1) < 2)
+    {
+        // Oversampling choices were 2x/4x; they now start at 1x
+        if (auto* oversampling = xmlState->getChildByAttribute("id", "oversampling"))
+            oversampling->setAttribute("value", oversampling->getDoubleAttribute("value") + 1.0);
+    }
+
+    if (xmlState->getIntAttribute("stateVersion", 1) < 3 && xmlState->getChildByAttribute("id", "sat_adaa") == nullptr)
+    {
+        // Saved before ADAA existed: keep the saturator as it was
+        auto* antialias = xmlState->createNewChildElement("PARAM");
+        antialias->setAttribute("id", "sat_adaa");
+        antialias->setAttribute("value", 0.0);
+    }
+
+    parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
 }
 
 //==============================================================================
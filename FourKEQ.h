@@ -1,9 +1,17 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "FourKBiquad.h"
+#include "FourKMatchedCoefficients.h"
+#include "FourKOversampler.h"
+#include "FourKTripleBuffer.h"
+#include "FourKWaveshaper.h"
 #include <array>
 #include <atomic>
 #include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 // Forward declaration for LV2 inline display
 
@@ -15,10 +23,12 @@
     - 4-band parametric EQ (LF, LM, HM, HF)
     - High-pass and low-pass filters
     - Brown/Black knob variants
-    - 2x/4x oversampling for anti-aliasing
+    - 1x to 16x oversampling for anti-aliasing, of the whole chain or just the saturator
     - Analog-modeled nonlinearities
 */
-class FourKEQ : public juce::AudioProcessor
+class FourKEQ : public juce::AudioProcessor,
+                private juce::TimeSliceClient,
+                private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -33,7 +43,22 @@ public:
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
     #endif
 
+    // The whole chain runs in the precision the host asks for
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+
+    /** The rate the saturator runs at on the live path: the host rate times
+        the oversampling factor in use (which with Auto depends on the host
+        rate), or just the host rate while the saturator is off. Safe to call
+        from any thread.
+    */
+    double getOversampledRate() const noexcept { return oversampledRate.load(); }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -67,60 +92,270 @@ public:
 
 private:
     //==============================================================================
-    // Filter chain for stereo processing
-    struct FilterBand
+    // Position of each biquad in the processing chain; the HPF's first-order
+    // section runs ahead of all of them
+    enum Section
     {
-        juce::dsp::IIR::Filter<float> filter;
-        juce::dsp::IIR::Filter<float> filterR;  // Right channel
+        hpfSection,
+        lfSection,
+        lmSection,
+        hmSection,
+        hfSection,
+        lpfSection,
+        numSections
+    };
 
-        void reset()
-        {
-            filter.reset();
-            filterR.reset();
-        }
+    // The cascade's own coefficient types, whatever it processes:
+    // normalised b0, b1, b2, a1, a2 and b0, b1, a1 (a0 == 1). Designed and
+    // smoothed in double precision, whatever the audio runs in.
+    using Biquad = FourKBiquadCascade<double, (size_t) numSections>::Coefficients;
+    using FirstOrder = FourKBiquadCascade<double, (size_t) numSections>::FirstOrderCoefficients;
 
-        void prepare(const juce::dsp::ProcessSpec& spec)
+    using SectionCoefficients = std::array<Biquad, (size_t) numSections>;
+
+    // Parameter values a band's coefficients were last designed from, so
+    // the designer can skip every band whose inputs have not moved.
+    struct DesignInputs
+    {
+        std::array<float, 5> values {};
+        bool valid = false;
+
+        bool changed(const std::array<float, 5>& newValues)
         {
-            filter.prepare(spec);
-            filterR.prepare(spec);
+            if (valid && newValues == values)
+                return false;
+
+            values = newValues;
+            valid = true;
+            return true;
         }
+
+        void invalidate() { valid = false; }
     };
 
-    // HPF: 3rd order (18 dB/oct) implemented as cascaded filters
-    struct HighPassFilter
+    // Filter chain: HPF (1st + 2nd order) -> LF -> LM -> HM -> HF -> LPF.
+    // Channels run in the lanes of SIMD registers, a register's worth at a
+    // time (4 floats or 2 doubles with SSE or NEON): one chain per group of
+    // lanes, all with the same coefficients. A stereo pair is one group,
+    // 7.1.4 is three in float. Mono layouts fall back to the scalar
+    // cascade. Float or double, as the host processes (see Engine below).
+    template <typename SampleType>
+    using ChannelFrame = juce::dsp::SIMDRegister<SampleType>;
+
+    template <typename SampleType>
+    using FrameChain = FourKBiquadCascade<ChannelFrame<SampleType>, numSections>;
+
+    template <typename SampleType>
+    using MonoChain = FourKBiquadCascade<SampleType, numSections>;
+
+    // Bands designed as an exact identity are dropped from the chain. A
+    // gain this close to 0 dB counts as flat, and the HPF/LPF count as
+    // out when parked at the end of their range.
+    static constexpr float flatGainThresholdDb = 0.01f;
+    float hpfParkedFrequency = 20.0f;
+    float lpfParkedFrequency = 20000.0f;
+
+    // First-order antiderivative anti-aliasing (ADAA) for the saturator:
+    // each output is the curve's mean between the previous input and this
+    // one, i.e. the difference of its antiderivative over the difference of
+    // the inputs. That cancels much of the aliasing before any oversampling
+    // does, at the cost of half a sample of delay and a two-sample average
+    // on the saturated signal. That average is a cos(pi f / fs) low-pass,
+    // which is only inaudible at an oversampled rate, so ADAA is never used
+    // at 1x. Consecutive inputs too close for the quotient fall back to the
+    // curve at their midpoint.
+    struct AntiderivativeState
     {
-        FilterBand stage1;  // First biquad
-        FilterBand stage2;  // Second biquad (combined gives ~18dB/oct)
+        double previousInput = 0.0;
+        double previousIntegral = 0.0;      // Antiderivative at previousInput, for previousAmount and previousCurve
+        float previousAmount = 0.0f;
+        const FourKWaveshaper* previousCurve = nullptr;
+    };
 
-        void reset()
-        {
-            stage1.reset();
-            stage2.reset();
-        }
+    static constexpr double antiderivativeMinimumStep = 1.0e-5;
+
+    // What a filter-rate chunk does after the filters. Chosen once per
+    // block, along with mono or SIMD lanes, to pick a chunk kernel (see
+    // getChunkKernel), so the kernels themselves test nothing at run time.
+    enum SaturationMode
+    {
+        saturationOff,
+        saturationPlain,
+        saturationAntiderivative,
+        numSaturationModes
+    };
+
+    // Asymmetric curves put DC on the saturated signal, which a transformer
+    // wouldn't pass. A one-pole high-pass at the host rate takes it out; it
+    // fades in and out with such a curve and costs nothing otherwise.
+    static constexpr double dcBlockerFrequency = 5.0;
+
+    double dcBlockerCoefficient = 0.0;
+    std::vector<double> dcEstimates;                            // One per channel
+    juce::SmoothedValue<float> dcBlockerMix;
+
+    template <typename SampleType>
+    void removeSaturationDC(juce::dsp::AudioBlock<SampleType>& block);
+
+    std::vector<AntiderivativeState> antiderivativeStates;     // Live path, one per channel
+
+    // Oversampling, 1x to 16x. Either the whole chain runs oversampled, or
+    // the filters run at the host rate with matched designs and only the
+    // saturator is oversampled. With the saturator off the chain is linear
+    // and nothing is oversampled at all; a delay stands in for the
+    // oversampler's latency so switching in and out doesn't move the output
+    // in time. 1x runs everything at the host rate with no added latency.
+    // ADAA (see above) adds half a sample at the oversampled rate, which the
+    // linear paths match in the same way. The half-band filters are minimum
+    // phase IIR, or linear phase FIR at several times the latency.
+    //
+    // Every path's latency is a whole number of host samples, so the dry
+    // signal and the linear paths only ever need an integer delay, which is
+    // exactly transparent.
+    // An oversampled path makes up the fraction its half-bands and ADAA leave
+    // with a pad at the oversampled rate: a Thiran allpass, flat in
+    // magnitude, whose phase only bends far above the audio band.
+    template <typename SampleType>
+    using Oversampler = FourKOversampler<SampleType>;
+
+    using OversamplingFilter = FourKOversamplerBase::FilterType;
+
+    template <typename SampleType>
+    using LatencyDelay = juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None>;
+
+    template <typename SampleType>
+    using PadDelay = juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::Thiran>;
+
+    // Oversampler latencies a hair past a whole sample still round down
+    static constexpr float latencyTolerance = 1.0e-3f;
+
+    static constexpr int maxOversamplingStages = 4;    // 16x
+
+    // Auto picks the smallest factor that takes the saturator to at least
+    // autoMinimumRate. That's enough for the 7th harmonic of a 20 kHz tone
+    // to fold back above 20 kHz; at the default drive everything past it is
+    // more than 60 dB down. 4x at 44.1/48 kHz, 2x at 88.2/96, 1x from 176.4.
+    static constexpr int autoOversamplingChoice = 5;
+    static constexpr double autoMinimumRate = 160000.0;
+
+    static constexpr double oversamplingStopbandDb = 90.0;
+
+    struct OversamplingConfig
+    {
+        int factor = 2;
+        bool saturatorOnly = false;
+        OversamplingFilter filterType = FourKOversamplerBase::filterPolyphaseIIR;
+        bool linear = false;            // Saturation off: no oversampler
+        bool antiderivative = false;    // ADAA saturator
+        FourKWaveshaper::Curve curve = FourKWaveshaper::curveTanh;
+
+        // Multiple of the host rate the filter chain runs at
+        int getFilterFactor() const noexcept { return (saturatorOnly || linear) ? 1 : factor; }
+
+        // Host-rate latency of the saturator itself
+        float getSaturatorLatency() const noexcept { return antiderivative ? 0.5f / (float) factor : 0.0f; }
 
-        void prepare(const juce::dsp::ProcessSpec& spec)
+        // Only an asymmetric curve that actually saturates puts DC on the signal
+        bool needsDcBlocker() const noexcept { return ! linear && ! FourKWaveshaper::isSymmetric(curve); }
+
+        bool operator== (const OversamplingConfig& other) const noexcept
         {
-            stage1.prepare(spec);
-            stage2.prepare(spec);
+            return factor == other.factor && saturatorOnly == other.saturatorOnly && linear == other.linear
+                && filterType == other.filterType && antiderivative == other.antiderivative
+                && curve == other.curve;
         }
+
+        bool operator!= (const OversamplingConfig& other) const noexcept { return ! operator== (other); }
+    };
+
+    // A path's audio side, in one precision
+    template <typename SampleType>
+    struct PathProcessor
+    {
+        std::unique_ptr<Oversampler<SampleType>> oversampler;   // Null on a host-rate path
+        PadDelay<SampleType> padDelay;                          // Oversampled paths only
+        LatencyDelay<SampleType> latencyDelay;                  // Linear path only
+    };
+
+    struct OversamplingPath
+    {
+        OversamplingConfig config;
+        int latency = 0;                            // Host-rate samples, the same either way
+        float padding = 0.0f;                       // Oversampled samples making it up to latency
+
+        // Only the one for the prepared precision is built
+        std::tuple<PathProcessor<float>, PathProcessor<double>> processors;
+
+        template <typename SampleType>
+        PathProcessor<SampleType>& get() noexcept { return std::get<PathProcessor<SampleType>>(processors); }
     };
 
-    // LPF: 2nd order (12 dB/oct)
-    FilterBand lpfFilter;
+    // Only the active configuration has an oversampler: a new one is built
+    // by the designer thread and handed to processBlock through pendingPath,
+    // and the one it replaces goes back through retiredPath to be freed off
+    // the audio thread.
+    std::unique_ptr<OversamplingPath> path;
+    std::atomic<OversamplingPath*> pendingPath { nullptr };
+    std::atomic<OversamplingPath*> retiredPath { nullptr };
+    OversamplingConfig designedConfig;              // Designer side: newest configuration built
+    int preparedNumChannels = 0;
+    bool preparedDoublePrecision = false;
+
+    // Render or live is decided when the host prepares, never in between:
+    // the render path has a different latency, and a host that changes its
+    // mode without preparing again wouldn't pick that up before the bounce.
+    // Such a host renders at the live setting.
+    bool preparedNonRealtime = false;
+
+    // processBlock cuts host blocks into sub-blocks of at most this many
+    // samples, and every buffer, delay and oversampler is sized for one.
+    // Hosts may then send blocks of any size, larger than announced
+    // included, and the scratch the chain touches (16x of it oversampled)
+    // stays in L1/L2.
+    static constexpr int subBlockSize = 64;
+
+    // On a switch the outgoing path keeps running, with the chain state and
+    // coefficients it had at the switch (its chains live in the Engine), and
+    // is crossfaded out against the incoming one at the host rate.
+    struct FadingPath
+    {
+        std::unique_ptr<OversamplingPath> path;
+        float saturation = 0.0f;
+        std::vector<AntiderivativeState> antiderivativeStates;
+    };
+
+    static constexpr double crossfadeTimeSeconds = 0.02;
+
+    FadingPath fadingPath;
+    int crossfadeLength = 0;
+    int crossfadeSamplesRemaining = 0;
+
+    // Latency reporting. The designer thread knows a path's latency as soon
+    // as it builds it and passes it to the message thread, where
+    // setLatencySamples() is called.
+    std::atomic<int> pendingLatencySamples { 0 };
+    void handleAsyncUpdate() override;
 
-    // HPF structure
-    HighPassFilter hpfFilter;
+    std::atomic<double> oversampledRate { 0.0 };    // Live path, for the editor
 
-    // 4-band EQ filters
-    FilterBand lfFilter;   // Low frequency
-    FilterBand lmFilter;   // Low-mid frequency
-    FilterBand hmFilter;   // High-mid frequency
-    FilterBand hfFilter;   // High frequency
+    // Bypass. The dry signal always runs through a delay matching the live
+    // path's latency, so bypass can fade in or out at any moment without
+    // shifting the timing.
+    static constexpr double bypassFadeTimeSeconds = 0.01;
 
-    // Oversampling
-    std::unique_ptr<juce::dsp::Oversampling<float>> oversampler2x;
-    std::unique_ptr<juce::dsp::Oversampling<float>> oversampler4x;
-    int oversamplingFactor = 2;
+    juce::SmoothedValue<float> bypassMix;           // 0 = processed, 1 = dry
+
+    // When a switch changes the latency the dry tap moves with it, by a
+    // crossfade from the old tap over the same time as a bypass fade
+    int dryDelay = 0;
+    int previousDryDelay = 0;
+    juce::SmoothedValue<float> dryDelayFade;        // 0 = previous tap, 1 = new one
+
+    template <typename SampleType>
+    void delayDrySignal(const juce::dsp::AudioBlock<SampleType>& block);
+
+    template <typename SampleType>
+    void mixInDrySignal(juce::dsp::AudioBlock<SampleType>& block);
 
     // Parameter pointers
     std::atomic<float>* hpfFreqParam = nullptr;
@@ -146,26 +381,274 @@ private:
     std::atomic<float>* bypassParam = nullptr;
     std::atomic<float>* outputGainParam = nullptr;
     std::atomic<float>* saturationParam = nullptr;
-    std::atomic<float>* oversamplingParam = nullptr; // 0 = 2x, 1 = 4x
+    std::atomic<float>* oversamplingParam = nullptr; // 0 = 1x, 1 = 2x ... 4 = 16x, 5 = Auto
+    std::atomic<float>* oversamplingModeParam = nullptr; // 0 = Full, 1 = Saturator Only
+    std::atomic<float>* oversamplingFilterParam = nullptr; // 0 = Minimum Phase, 1 = Linear Phase
+    std::atomic<float>* saturationAntialiasParam = nullptr;
+    std::atomic<float>* saturationCurveParam = nullptr; // FourKWaveshaper::Curve
+    std::atomic<float>* renderOversamplingParam = nullptr; // 0 = Live Setting, 1 = 4x, 2 = 8x, 3 = 16x
+
+    // Every parameter, read from the atomics once per block (and once per
+    // designer pass) so the code below works on plain values that all come
+    // from the same moment. Output gain and saturation are ramped from here
+    // by the smoothing engine.
+    struct ParameterSnapshot
+    {
+        float hpfFreq = 0.0f;
+        float lpfFreq = 0.0f;
+
+        float lfGain = 0.0f, lfFreq = 0.0f;
+        bool lfBell = false;
+
+        float lmGain = 0.0f, lmFreq = 0.0f, lmQ = 0.0f;
+        float hmGain = 0.0f, hmFreq = 0.0f, hmQ = 0.0f;
+
+        float hfGain = 0.0f, hfFreq = 0.0f;
+        bool hfBell = false;
+
+        bool isBlack = false;
+        bool bypass = false;
+        float outputGain = 1.0f;        // Linear
+        float saturation = 0.0f;        // 0..1
+        int saturationCurve = 0;
+        int oversamplingChoice = 0;
+        bool saturatorOnly = false;
+        bool linearPhase = false;
+        bool antiderivative = false;
+        int renderOversampling = 0;
+    };
+
+    ParameterSnapshot readParameters() const noexcept;
 
     // Processing state
     double currentSampleRate = 44100.0;
 
-    // Filter update methods
-    void updateFilters();
-    void updateHPF(double sampleRate);
-    void updateLPF(double sampleRate);
-    void updateLFBand(double sampleRate);
-    void updateLMBand(double sampleRate);
-    void updateHMBand(double sampleRate);
-    void updateHFBand(double sampleRate);
+    //==============================================================================
+    // Coefficient design runs on a shared background thread and is handed to
+    // processBlock through a triple buffer, so automation only ever costs the
+    // audio thread a copy of the finished coefficients.
+    struct CoefficientSet
+    {
+        FirstOrder hpfFirstOrder { 1.0, 0.0, 0.0 };
+        SectionCoefficients sections {};
+        int filterFactor = 0;           // Filter rate the set was designed for, as a multiple of the host rate
+    };
+
+    struct DesignerThread : juce::TimeSliceThread
+    {
+        DesignerThread() : juce::TimeSliceThread("4K EQ Coefficient Designer") { startThread(); }
+        ~DesignerThread() override { stopThread(1000); }
+    };
+
+    static constexpr int designerIntervalMs = 2;
+
+    juce::SharedResourcePointer<DesignerThread> designerThread;
+    juce::SpinLock designLock;                      // Serialises designer thread vs. offline rendering
+    CoefficientSet designedCoefficients;            // Designer-side master copy
+    DesignInputs hpfInputs, lpfInputs, lfInputs, lmInputs, hmInputs, hfInputs;
+    FourKTripleBuffer<CoefficientSet> coefficientHandoff;
+    CoefficientSet heldCoefficients;                // Audio side: set waiting for its path
+    bool hasHeldCoefficients = false;
+
+    int useTimeSlice() override;
+    void runDesigner();
+    void invalidateDesigns();
+    OversamplingConfig getRequestedConfig(const ParameterSnapshot& params) const;
+    std::unique_ptr<OversamplingPath> createPath(const OversamplingConfig& config) const;
+
+    template <typename SampleType>
+    void preparePathProcessor(OversamplingPath& newPath) const;
+
+    static int getNumOversamplingStages(int factor);
+    static int getAutoOversamplingFactor(double sampleRate);
+
+    template <typename SampleType>
+    static std::unique_ptr<Oversampler<SampleType>> createOversampler(int factor, OversamplingFilter filterType,
+                                                                      size_t numChannels);
+
+    static float getOversamplerLatency(int factor, OversamplingFilter filterType);
+    std::unique_ptr<OversamplingPath> updatePath(const ParameterSnapshot& params);
+
+    template <typename SampleType>
+    void adoptPendingPath();
+
+    void retireFadingPath();
+    void freeSparePaths();
+
+    void receiveCoefficients(const CoefficientSet& set);
+
+    template <typename SampleType>
+    void applyCoefficients(const CoefficientSet& set);
+
+    static Biquad normalise(const std::array<double, 6>& coefficients);
+    static FirstOrder normalise(const std::array<double, 4>& coefficients);
+
+    // Bilinear designs when the filters run oversampled, matched designs
+    // when they run at the host rate
+    Biquad designHighPass(double sampleRate, float freq, float q) const;
+    Biquad designLowPass(double sampleRate, float freq, float q) const;
+    Biquad designPeakFilter(double sampleRate, float freq, float q, float gainFactor) const;
+    Biquad designLowShelf(double sampleRate, float freq, float q, float gainFactor) const;
+    Biquad designHighShelf(double sampleRate, float freq, float q, float gainFactor) const;
+    FirstOrder designFirstOrderHighPass(double sampleRate, float freq) const;
+
+    //==============================================================================
+    // Smoothing engine for the filter chain. Every controlInterval filter-rate
+    // samples it picks up the newest designed set and glides the running
+    // coefficients towards it; output gain and saturation are ramped per
+    // sample. Cost per sample is the same whatever the host block size.
+    struct SmoothingEngine
+    {
+        static constexpr int controlInterval = 32;          // Filter-rate samples per tick
+        static constexpr double glideTimeSeconds = 0.01;    // Coefficient glide time constant
+        static constexpr double settleThreshold = 1.0e-7;
+
+        CoefficientSet current;
+        CoefficientSet target;
+        double glide = 1.0;         // Fraction of the remaining distance covered per tick
+        bool settled = true;
+        int samplesUntilTick = 0;
+        double filterRate = 0.0;
+        double saturationRate = 0.0;
+
+        juce::SmoothedValue<float> outputGain;   // Linear gain, per host sample
+        juce::SmoothedValue<float> saturation;   // 0..1, per oversampled sample
+
+        void setRates(double newFilterRate, double newSaturationRate);
+        void setTarget(const CoefficientSet& newTarget);
+        void snapToTarget();
+        bool tick();
+    };
+
+    SmoothingEngine smoothing;
+
+    //==============================================================================
+    // Everything that carries audio, in one precision. prepareToPlay sets up
+    // the engine for the precision the host will process in and empties the
+    // other one.
+    template <typename SampleType>
+    struct Engine
+    {
+        std::vector<FrameChain<SampleType>> frameChains;    // One per group of lanes
+        MonoChain<SampleType> monoChain;
+
+        // The outgoing path's chains during a crossfade
+        std::vector<FrameChain<SampleType>> fadingFrameChains;
+        MonoChain<SampleType> fadingMonoChain;
+        juce::AudioBuffer<SampleType> crossfadeBuffer;
+
+        LatencyDelay<SampleType> bypassDelay;
+        juce::AudioBuffer<SampleType> dryBuffer;
+
+        // One group of channels interleaved into SIMD lanes, one control
+        // chunk at a time
+        std::array<ChannelFrame<SampleType>, SmoothingEngine::controlInterval> frameScratch;
+    };
+
+    Engine<float> floatEngine;
+    Engine<double> doubleEngine;
+
+    template <typename SampleType>
+    Engine<SampleType>& getEngine() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleEngine;
+        else
+            return floatEngine;
+    }
+
+    template <typename SampleType>
+    void prepareEngine(float maxLatency);
+
+    template <typename SampleType>
+    void releaseEngine();
+
+    template <typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& buffer);
+
+    template <typename SampleType>
+    void processSubBlock(juce::dsp::AudioBlock<SampleType>& block, const ParameterSnapshot& params);
+
+    template <typename SampleType>
+    void processBypassed(juce::AudioBuffer<SampleType>& buffer);
+
+    // Filter design methods (designer side); each returns true if it changed
+    bool updateFilters(const ParameterSnapshot& params);
+    bool updateHPF(double sampleRate, const ParameterSnapshot& params);
+    bool updateLPF(double sampleRate, const ParameterSnapshot& params);
+    bool updateLFBand(double sampleRate, const ParameterSnapshot& params);
+    bool updateLMBand(double sampleRate, const ParameterSnapshot& params);
+    bool updateHMBand(double sampleRate, const ParameterSnapshot& params);
+    bool updateHFBand(double sampleRate, const ParameterSnapshot& params);
+
+    // Runs one control chunk of a filter-rate block through a set of chains,
+    // the SIMD ones or the mono one, then the saturator as the mode says.
+    // saturationAmounts and antiderivative are only read by the modes that
+    // need them.
+    template <typename SampleType, bool UseFrames, SaturationMode Saturation>
+    void processChunk(std::vector<FrameChain<SampleType>>& frameChains, MonoChain<SampleType>& mono,
+                      juce::dsp::AudioBlock<SampleType>& block, size_t position, size_t length,
+                      const float* saturationAmounts, const FourKWaveshaper& curve,
+                      AntiderivativeState* antiderivative);
+
+    template <typename SampleType>
+    using ChunkKernel = void (FourKEQ::*)(std::vector<FrameChain<SampleType>>&, MonoChain<SampleType>&,
+                                          juce::dsp::AudioBlock<SampleType>&, size_t, size_t,
+                                          const float*, const FourKWaveshaper&, AntiderivativeState*);
+
+    template <typename SampleType>
+    static ChunkKernel<SampleType> getChunkKernel(size_t numChannels, SaturationMode saturation) noexcept;
+
+    template <typename SampleType>
+    void processFilters(juce::dsp::AudioBlock<SampleType>& block, bool withSaturation);
+
+    template <typename SampleType>
+    static void saturateBlock(juce::dsp::AudioBlock<SampleType>& block, juce::SmoothedValue<float>& amount,
+                              const FourKWaveshaper& curve, AntiderivativeState* antiderivative);
+
+    template <typename SampleType, typename InterpolationType>
+    static void delayBlock(juce::dsp::AudioBlock<SampleType>& block,
+                           juce::dsp::DelayLine<SampleType, InterpolationType>& delay);
+
+    template <typename SampleType>
+    void processFadingPath(const juce::dsp::AudioBlock<SampleType>& input);
+
+    template <typename SampleType>
+    void mixInFadingPath(juce::dsp::AudioBlock<SampleType>& block);
+
+    template <typename SampleType>
+    void applyOutputGain(juce::dsp::AudioBlock<SampleType>& block);
 
     // Helper methods
     float calculateDynamicQ(float gain, float baseQ) const;
-    float applySaturation(float sample, float amount) const;
+
+    // Saturation over runs of samples, one amount per sample (per frame for
+    // ChannelFrames), written as plain loops so they vectorise
+    template <typename SampleType>
+    static SampleType applySaturation(SampleType sample, float amount, const FourKWaveshaper& curve) noexcept;
+
+    template <typename SampleType>
+    static void applySaturation(SampleType* samples, size_t numSamples, const float* amounts,
+                                const FourKWaveshaper& curve) noexcept;
+
+    template <typename SampleType>
+    static void applySaturation(ChannelFrame<SampleType>* frames, size_t numFrames, const float* amounts,
+                                const FourKWaveshaper& curve) noexcept;
+
+    // ADAA over one channel, every stride samples (a lane of ChannelFrames)
+    template <typename SampleType>
+    static void applyAntiderivativeSaturation(SampleType* samples, size_t stride, size_t numSamples,
+                                              const float* amounts, const FourKWaveshaper& curve,
+                                              AntiderivativeState& state) noexcept;
+    static double getSaturationIntegral(double sample, float amount, const FourKWaveshaper& curve) noexcept;
 
     // Parameter creation
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
+    // Saved state layout. Version 1 sessions predate the 1x/8x/16x
+    // oversampling choices, when index 0 meant 2x. Version 2 sessions
+    // predate ADAA and load with it off, so they sound as they did.
+    static constexpr int currentStateVersion = 3;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FourKEQ)
 };
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+
+//==============================================================================
+/**
+    Biquad designs whose magnitude response follows the analog prototype all
+    the way to Nyquist, for filters that run at the host rate.
+
+    The bilinear transform squeezes the whole analog frequency axis into
+    0..Nyquist, so at 44.1/48 kHz bells and shelves above a few kHz come out
+    narrower than the analog curve - which is what running the filters
+    oversampled used to hide. Here the poles are placed by impulse invariance
+    and the numerator is solved so that the digital magnitude equals the
+    analog one exactly at DC, at Nyquist and at the corner frequency
+    (M. Vicanek, "Matched Second Order Digital Filters").
+
+    Same arguments and result layout as juce::dsp::IIR::ArrayCoefficients:
+    b0, b1, b2, a0, a1, a2 (first order: b0, b1, a0, a1), in double
+    precision.
+*/
+struct FourKMatchedCoefficients
+{
+    using Complex = std::complex<double>;
+
+    static std::array<double, 6> makeLowPass(double sampleRate, float frequency, float Q)
+    {
+        return design(sampleRate, frequency, Q, frequency,
+                      [=] (Complex s) { return 1.0 / (s * s + s / (double) Q + 1.0); });
+    }
+
+    static std::array<double, 6> makeHighPass(double sampleRate, float frequency, float Q)
+    {
+        return design(sampleRate, frequency, Q, frequency,
+                      [=] (Complex s) { return s * s / (s * s + s / (double) Q + 1.0); });
+    }
+
+    static std::array<double, 6> makePeakFilter(double sampleRate, float frequency, float Q, float gainFactor)
+    {
+        // A cut is the exact inverse of the boost by the same amount. Impulse
+        // invariance places the sharp poles of a boost well, but not the
+        // broad, overdamped ones of a deep cut, so cuts are designed as boosts
+        if (gainFactor < 1.0f)
+            return invert(makePeakFilter(sampleRate, frequency, Q, 1.0f / gainFactor));
+
+        const double A = std::sqrt((double) gainFactor);
+
+        return design(sampleRate, frequency, Q * A, frequency,
+                      [=] (Complex s) { return (s * s + s * A / (double) Q + 1.0)
+                                             / (s * s + s / (A * Q) + 1.0); });
+    }
+
+    static std::array<double, 6> makeLowShelf(double sampleRate, float frequency, float Q, float gainFactor)
+    {
+        // Designed with the poles below the corner, as for the peak filter
+        if (gainFactor < 1.0f)
+            return invert(makeLowShelf(sampleRate, frequency, Q, 1.0f / gainFactor));
+
+        const double A = std::sqrt((double) gainFactor);
+        const double rootA = std::sqrt(A);
+
+        return design(sampleRate, frequency / rootA, Q, frequency,
+                      [=] (Complex s) { return A * (s * s + s * rootA / (double) Q + A)
+                                                 / (A * s * s + s * rootA / (double) Q + 1.0); });
+    }
+
+    static std::array<double, 6> makeHighShelf(double sampleRate, float frequency, float Q, float gainFactor)
+    {
+        if (gainFactor > 1.0f)
+            return invert(makeHighShelf(sampleRate, frequency, Q, 1.0f / gainFactor));
+
+        const double A = std::sqrt((double) gainFactor);
+        const double rootA = std::sqrt(A);
+
+        return design(sampleRate, frequency * rootA, Q, frequency,
+                      [=] (Complex s) { return A * (A * s * s + s * rootA / (double) Q + 1.0)
+                                                 / (s * s + s * rootA / (double) Q + A); });
+    }
+
+    static std::array<double, 4> makeFirstOrderHighPass(double sampleRate, float frequency)
+    {
+        // Pole by impulse invariance, zero at DC, gain matched at Nyquist
+        const double pole = std::exp(-juce::MathConstants<double>::twoPi * frequency / sampleRate);
+        const Complex s(0.0, 0.5 * sampleRate / frequency);
+        const double b0 = 0.5 * (1.0 + pole) * std::abs(s / (s + 1.0));
+
+        return { b0, -b0, 1.0, -pole };
+    }
+
+private:
+    //==============================================================================
+    // Pole and match frequencies are kept clear of Nyquist, where both
+    // constraints degenerate
+    static constexpr double maxFrequencyRatio = 0.45;
+
+    template <typename Response>
+    static std::array<double, 6> design(double sampleRate, double poleFrequency, double poleQ,
+                                       double frequency, Response response)
+    {
+        // Poles: impulse invariant mapping of the analog pole pair
+        const double w = juce::MathConstants<double>::twoPi * std::min(poleFrequency, maxFrequencyRatio * sampleRate)
+                       / sampleRate;
+        const double zeta = 0.5 / poleQ;
+        const double decay = std::exp(-zeta * w);
+        const double a1 = zeta <= 1.0 ? -2.0 * decay * std::cos(std::sqrt(1.0 - zeta * zeta) * w)
+                                      : -2.0 * decay * std::cosh(std::sqrt(zeta * zeta - 1.0) * w);
+        const double a2 = decay * decay;
+
+        // |H|^2 of a biquad is linear in B0 = (b0 + b1 + b2)^2,
+        // B1 = (b0 - b1 + b2)^2 and B2 = -4 b0 b2; pin it to the analog
+        // response at DC, Nyquist and the match frequency
+        auto analogMagnitudeSquared = [&] (double f) { return std::norm(response(Complex(0.0, f / frequency))); };
+
+        const double matchFrequency = std::min(frequency, maxFrequencyRatio * sampleRate);
+        const double phi1 = square(std::sin(juce::MathConstants<double>::pi * matchFrequency / sampleRate));
+        const double phi0 = 1.0 - phi1;
+        const double phi2 = 4.0 * phi0 * phi1;
+
+        const double A0 = square(1.0 + a1 + a2);
+        const double A1 = square(1.0 - a1 + a2);
+        const double A2 = -4.0 * a2;
+
+        const double B0 = A0 * analogMagnitudeSquared(0.0);
+        const double B1 = A1 * analogMagnitudeSquared(0.5 * sampleRate);
+        const double B2 = (analogMagnitudeSquared(matchFrequency) * (A0 * phi0 + A1 * phi1 + A2 * phi2)
+                           - B0 * phi0 - B1 * phi1) / phi2;
+
+        // Back to the minimum phase numerator
+        const double root0 = std::sqrt(B0);
+        const double root1 = std::sqrt(B1);
+        const double sum = 0.5 * (root0 + root1);
+        const double b0 = 0.5 * (sum + std::sqrt(std::max(0.0, sum * sum + B2)));
+        const double b1 = 0.5 * (root0 - root1);
+        const double b2 = -B2 / (4.0 * b0);
+
+        return { b0, b1, b2, 1.0, a1, a2 };
+    }
+
+    static std::array<double, 6> invert(const std::array<double, 6>& c)
+    {
+        return { c[3], c[4], c[5], c[0], c[1], c[2] };
+    }
+
+    static double square(double x) { return x * x; }
+};
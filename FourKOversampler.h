@@ -0,0 +1,552 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+//==============================================================================
+/**
+    Polyphase IIR half-band 2x stage: two chains of first-order allpasses in
+    z^-2, one per output phase (O. Niemitalo / L. de Soras' polyphase
+    design). Minimum phase, very cheap, with the attenuation and transition
+    band of an elliptic half-band filter.
+
+    SampleType is float or double, or a juce::dsp::SIMDRegister of either
+    holding one channel per lane; the coefficients are shared by all lanes.
+*/
+template <typename SampleType>
+class FourKPolyphaseIIRStage
+{
+public:
+    static constexpr size_t maxNumCoefficients = 12;
+
+    /** transitionBand is the half width of the transition band around a
+        quarter of the high rate, as a fraction of the high rate.
+    */
+    FourKPolyphaseIIRStage(double attenuationDb, double transitionBand)
+    {
+        double k, q;
+        computeTransitionParameters(transitionBand, k, q);
+
+        // Order of the equivalent elliptic filter, odd and at least 3
+        const double attenuation = std::pow(10.0, -attenuationDb / 10.0);
+        const double a = attenuation / (1.0 - attenuation);
+        int order = (int) std::ceil(std::log(a * a / 16.0) / std::log(q));
+        order = std::max(3, order | 1);
+
+        numCoefficients = std::min(maxNumCoefficients, (size_t) (order - 1) / 2);
+        order = (int) numCoefficients * 2 + 1;
+
+        for (size_t i = 0; i < numCoefficients; ++i)
+        {
+            auto coefficient = computeCoefficient((int) i + 1, k, q, order);
+            upSections[i].coefficient = downSections[i].coefficient = broadcast(coefficient);
+
+            // Each allpass (a + z^-2) / (1 + a z^-2) delays DC by 2 (1 - a) / (1 + a)
+            latency += (1.0 - coefficient) / (1.0 + coefficient);
+        }
+
+        // Up and down together come to twice the allpass delay: the half
+        // sample between the two branches, in each direction, makes up for
+        // the sample the downsampler waits for the second half of each pair
+        latency *= 2.0;
+        reset();
+    }
+
+    size_t getNumCoefficients() const noexcept { return numCoefficients; }
+
+    /** Round-trip latency of upsample() followed by downsample(), in
+        samples at the high rate.
+    */
+    double getLatency() const noexcept { return latency; }
+
+    void reset() noexcept
+    {
+        for (auto* sections : { &upSections, &downSections })
+        {
+            for (auto& section : *sections)
+            {
+                section.x1 = broadcast(0.0);
+                section.y1 = broadcast(0.0);
+            }
+        }
+    }
+
+    //==============================================================================
+    void upsample(const SampleType* input, SampleType* output, size_t numInputSamples) noexcept
+    {
+        auto local = upSections;
+
+        for (size_t i = 0; i < numInputSamples; ++i)
+        {
+            auto even = input[i];
+            auto odd = input[i];
+            processPair(local, even, odd);
+
+            output[2 * i] = even;
+            output[2 * i + 1] = odd;
+        }
+
+        upSections = local;
+    }
+
+    void downsample(const SampleType* input, SampleType* output, size_t numOutputSamples) noexcept
+    {
+        auto local = downSections;
+
+        for (size_t i = 0; i < numOutputSamples; ++i)
+        {
+            auto even = input[2 * i + 1];
+            auto odd = input[2 * i];
+            processPair(local, even, odd);
+
+            output[i] = (even + odd) * broadcast(0.5);
+        }
+
+        downSections = local;
+    }
+
+private:
+    //==============================================================================
+    struct Section
+    {
+        SampleType coefficient, x1, y1;
+    };
+
+    using Sections = std::array<Section, maxNumCoefficients>;
+
+    void processPair(Sections& local, SampleType& even, SampleType& odd) const noexcept
+    {
+        // Sections alternate between the two branches
+        for (size_t k = 0; k < numCoefficients; k += 2)
+        {
+            even = processSection(local[k], even);
+
+            if (k + 1 < numCoefficients)
+                odd = processSection(local[k + 1], odd);
+        }
+    }
+
+    static SampleType processSection(Section& section, SampleType x) noexcept
+    {
+        auto y = (x - section.y1) * section.coefficient + section.x1;
+        section.x1 = x;
+        section.y1 = y;
+        return y;
+    }
+
+    static void computeTransitionParameters(double transitionBand, double& k, double& q)
+    {
+        k = std::tan((1.0 - transitionBand * 2.0) * juce::MathConstants<double>::pi / 4.0);
+        k *= k;
+
+        const double kksqrt = std::pow(1.0 - k * k, 0.25);
+        const double e = 0.5 * (1.0 - kksqrt) / (1.0 + kksqrt);
+        const double e4 = e * e * e * e;
+
+        q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+    }
+
+    static double computeCoefficient(int index, double k, double q, int order)
+    {
+        const double pi = juce::MathConstants<double>::pi;
+
+        // Theta function series; the terms fall off as q^(i^2)
+        double numerator = 0.0, denominator = 0.0, sign = 1.0;
+
+        for (int i = 0; i < 32; ++i, sign = -sign)
+            numerator += sign * std::pow(q, i * (i + 1)) * std::sin((i * 2 + 1) * index * pi / order);
+
+        sign = -1.0;
+
+        for (int i = 1; i < 32; ++i, sign = -sign)
+            denominator += sign * std::pow(q, i * i) * std::cos(i * 2 * index * pi / order);
+
+        const double ww = numerator * std::pow(q, 0.25) / (denominator + 0.5);
+        const double wwsq = ww * ww;
+        const double x = std::sqrt((1.0 - wwsq * k) * (1.0 - wwsq / k)) / (1.0 + wwsq);
+
+        return (1.0 - x) / (1.0 + x);
+    }
+
+    static SampleType broadcast(double value) noexcept
+    {
+        if constexpr (std::is_floating_point_v<SampleType>)
+            return (SampleType) value;
+        else
+            return SampleType::expand((typename SampleType::ElementType) value);
+    }
+
+    Sections upSections {}, downSections {};
+    size_t numCoefficients = 0;
+    double latency = 0.0;
+};
+
+//==============================================================================
+/**
+    Linear-phase half-band FIR 2x stage, Kaiser windowed. Every other tap of
+    a half-band filter is zero, so each phase only runs the taps it needs:
+    one output of every pair is a plain delay.
+
+    Same SampleType rules and interface as FourKPolyphaseIIRStage.
+*/
+template <typename SampleType>
+class FourKHalfBandFIRStage
+{
+public:
+    FourKHalfBandFIRStage(double attenuationDb, double transitionBand)
+    {
+        // Kaiser's estimates for the window shape and the length
+        const double beta = attenuationDb > 50.0 ? 0.1102 * (attenuationDb - 8.7)
+                                                 : 0.5842 * std::pow(attenuationDb - 21.0, 0.4) + 0.07886 * (attenuationDb - 21.0);
+        auto halfLength = (int) std::ceil((attenuationDb - 7.95) / (14.36 * 4.0 * transitionBand));
+        halfLength |= 1;                        // Centre tap on the odd phase
+
+        centreOffset = (size_t) halfLength;
+
+        for (int k = 1; k <= halfLength; k += 2)
+        {
+            const double ratio = (double) k / halfLength;
+            const double window = bessel(beta * std::sqrt(1.0 - ratio * ratio)) / bessel(beta);
+            const double x = juce::MathConstants<double>::halfPi * k;
+
+            taps.push_back({ 0.5 * std::sin(x) / x * window, (size_t) k });
+        }
+
+        for (auto* history : { &upHistory, &downEvenHistory, &downOddHistory })
+            history->samples.resize((centreOffset + 1) * 2);
+
+        reset();
+    }
+
+    size_t getNumTaps() const noexcept { return taps.size(); }
+
+    /** Round-trip latency of upsample() followed by downsample(), in
+        samples at the high rate: the filter's centre twice, less the
+        sample the downsampler waits for the second half of each pair.
+    */
+    double getLatency() const noexcept { return 2.0 * (double) centreOffset - 1.0; }
+
+    void reset() noexcept
+    {
+        for (auto* history : { &upHistory, &downEvenHistory, &downOddHistory })
+        {
+            std::fill(history->samples.begin(), history->samples.end(), broadcast(0.0));
+            history->writePosition = 0;
+        }
+    }
+
+    //==============================================================================
+    void upsample(const SampleType* input, SampleType* output, size_t numInputSamples) noexcept
+    {
+        for (size_t i = 0; i < numInputSamples; ++i)
+        {
+            auto* history = upHistory.push(input[i]);
+
+            // Zero stuffing doubles the gain of the taps
+            output[2 * i] = convolve(history) * broadcast(2.0);
+            output[2 * i + 1] = history[(centreOffset - 1) / 2];
+        }
+    }
+
+    void downsample(const SampleType* input, SampleType* output, size_t numOutputSamples) noexcept
+    {
+        for (size_t i = 0; i < numOutputSamples; ++i)
+        {
+            auto* evens = downEvenHistory.push(input[2 * i]);
+            auto* odds = downOddHistory.push(input[2 * i + 1]);
+
+            output[i] = evens[(centreOffset - 1) / 2] * broadcast(0.5) + convolve(odds);
+        }
+    }
+
+private:
+    //==============================================================================
+    struct Tap
+    {
+        double coefficient;
+        size_t offset;          // Distance from the centre, odd
+    };
+
+    // Each sample is written twice, so the newest half of the buffer is
+    // always contiguous, newest first
+    struct History
+    {
+        SampleType* push(SampleType sample) noexcept
+        {
+            auto size = samples.size() / 2;
+            auto* newest = samples.data() + writePosition;
+
+            newest[0] = sample;
+            newest[size] = sample;
+            writePosition = (writePosition == 0 ? size : writePosition) - 1;
+            return newest;
+        }
+
+        std::vector<SampleType> samples;
+        size_t writePosition = 0;
+    };
+
+    SampleType convolve(const SampleType* history) const noexcept
+    {
+        auto sum = broadcast(0.0);
+
+        for (auto& tap : taps)
+            sum += (history[(centreOffset + tap.offset) / 2] + history[(centreOffset - tap.offset) / 2])
+                 * broadcast(tap.coefficient);
+
+        return sum;
+    }
+
+    static double bessel(double x)
+    {
+        // Zeroth order modified Bessel function of the first kind
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; term > 1.0e-12 * sum; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    static SampleType broadcast(double value) noexcept
+    {
+        if constexpr (std::is_floating_point_v<SampleType>)
+            return (SampleType) value;
+        else
+            return SampleType::expand((typename SampleType::ElementType) value);
+    }
+
+    std::vector<Tap> taps;
+    size_t centreOffset = 0;
+    History upHistory, downEvenHistory, downOddHistory;
+};
+
+//==============================================================================
+/**
+    Cascade of 2x half-band stages for the plugin's oversampling, with the
+    same processSamplesUp / processSamplesDown interface as
+    juce::dsp::Oversampling.
+
+    Channels are packed one per SIMD lane, a register's worth at a time, so
+    a stereo pair goes through each stage as one instruction stream instead
+    of one channel after the other, and wider layouts take one stream per
+    group of lanes. The stages are either minimum phase IIR or
+    linear phase FIR, designed for a given stopband attenuation. The first
+    stage passes 0.4 of the host rate; each later one only has to keep its
+    images off that band, so its transition band widens and it gets cheaper.
+    Whatever the saturator produces above the host Nyquist folds back above
+    0.4 of the host rate at worst.
+
+    SampleType is float or double; the filter type is shared by both.
+*/
+struct FourKOversamplerBase
+{
+    enum FilterType
+    {
+        filterPolyphaseIIR,
+        filterLinearPhaseFIR
+    };
+};
+
+template <typename SampleType>
+class FourKOversampler : public FourKOversamplerBase
+{
+public:
+    using Frame = juce::dsp::SIMDRegister<SampleType>;
+
+    FourKOversampler(size_t numChannelsToUse, size_t numStagesToUse, FilterType type,
+                     double stopbandAttenuationDb = 90.0)
+        : numChannels(numChannelsToUse), numStages(numStagesToUse),
+          groups((numChannelsToUse + Frame::size() - 1) / Frame::size())
+    {
+        jassert(numChannels > 0);
+
+        const double attenuation = juce::jlimit(40.0, 140.0, stopbandAttenuationDb);
+
+        for (size_t index = 0; index < groups.size(); ++index)
+        {
+            auto& group = groups[index];
+            group.firstChannel = index * Frame::size();
+            group.numChannels = juce::jmin(Frame::size(), numChannels - group.firstChannel);
+
+            for (size_t stage = 0; stage < numStages; ++stage)
+            {
+                const double transitionBand = 0.25 - passband / (double) (1 << stage);
+
+                if (type == filterPolyphaseIIR)
+                    group.stages.push_back(std::make_unique<IIRStage>(attenuation, transitionBand));
+                else
+                    group.stages.push_back(std::make_unique<FIRStage>(attenuation, transitionBand));
+            }
+        }
+
+        // Every group runs the same stages
+        for (size_t stage = 0; stage < numStages; ++stage)
+            latency += groups[0].stages[stage]->getLatency() / (double) (2 << stage);
+    }
+
+    size_t getOversamplingFactor() const noexcept { return (size_t) 1 << numStages; }
+
+    /** Latency of the round trip in host-rate samples. */
+    float getLatencyInSamples() const noexcept { return (float) latency; }
+
+    void initProcessing(size_t maximumNumberOfSamplesBeforeOversampling)
+    {
+        for (auto& group : groups)
+        {
+            group.frames.resize(numStages + 1);
+
+            for (size_t stage = 0; stage <= numStages; ++stage)
+                group.frames[stage].resize(maximumNumberOfSamplesBeforeOversampling << stage);
+        }
+
+        oversampledBuffer.setSize((int) numChannels,
+                                  (int) (maximumNumberOfSamplesBeforeOversampling * getOversamplingFactor()));
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& group : groups)
+        {
+            for (auto& stage : group.stages)
+                stage->reset();
+
+            // Lanes past the group's last channel are never written and stay silent
+            for (auto& buffer : group.frames)
+                std::fill(buffer.begin(), buffer.end(), Frame::expand((SampleType) 0));
+        }
+
+        oversampledBuffer.clear();
+    }
+
+    //==============================================================================
+    juce::dsp::AudioBlock<SampleType> processSamplesUp(const juce::dsp::AudioBlock<const SampleType>& input) noexcept
+    {
+        auto numSamples = input.getNumSamples();
+        jassert((numSamples << numStages) <= groups[0].frames[numStages].size());
+
+        juce::dsp::AudioBlock<SampleType> oversampled(oversampledBuffer);
+        oversampled = oversampled.getSubBlock(0, numSamples << numStages);
+
+        for (auto& group : groups)
+        {
+            auto& frames = group.frames;
+            interleave(group, input, frames[0].data(), numSamples);
+
+            for (size_t stage = 0; stage < numStages; ++stage)
+                group.stages[stage]->upsample(frames[stage].data(), frames[stage + 1].data(), numSamples << stage);
+
+            deinterleave(group, frames[numStages].data(), oversampled);
+        }
+
+        return oversampled;
+    }
+
+    void processSamplesDown(juce::dsp::AudioBlock<SampleType>& output) noexcept
+    {
+        auto numSamples = output.getNumSamples();
+
+        juce::dsp::AudioBlock<SampleType> oversampled(oversampledBuffer);
+
+        for (auto& group : groups)
+        {
+            auto& frames = group.frames;
+            interleave(group, oversampled, frames[numStages].data(), numSamples << numStages);
+
+            for (size_t stage = numStages; stage > 0; --stage)
+                group.stages[stage - 1]->downsample(frames[stage].data(), frames[stage - 1].data(),
+                                                    numSamples << (stage - 1));
+
+            deinterleave(group, frames[0].data(), output);
+        }
+    }
+
+private:
+    //==============================================================================
+    struct Stage
+    {
+        virtual ~Stage() = default;
+        virtual double getLatency() const noexcept = 0;
+        virtual void reset() noexcept = 0;
+        virtual void upsample(const Frame* input, Frame* output, size_t numInputSamples) noexcept = 0;
+        virtual void downsample(const Frame* input, Frame* output, size_t numOutputSamples) noexcept = 0;
+    };
+
+    template <typename Filter>
+    struct StageImpl : Stage
+    {
+        StageImpl(double attenuationDb, double transitionBand) : filter(attenuationDb, transitionBand) {}
+
+        double getLatency() const noexcept override { return filter.getLatency(); }
+        void reset() noexcept override { filter.reset(); }
+
+        void upsample(const Frame* input, Frame* output, size_t numInputSamples) noexcept override
+        {
+            filter.upsample(input, output, numInputSamples);
+        }
+
+        void downsample(const Frame* input, Frame* output, size_t numOutputSamples) noexcept override
+        {
+            filter.downsample(input, output, numOutputSamples);
+        }
+
+        Filter filter;
+    };
+
+    using IIRStage = StageImpl<FourKPolyphaseIIRStage<Frame>>;
+    using FIRStage = StageImpl<FourKHalfBandFIRStage<Frame>>;
+
+    // Passband of the first stage, as a fraction of its (2x) rate
+    static constexpr double passband = 0.2;
+
+    // Up to Frame::size() consecutive channels, one per lane, with their own
+    // filter state and buffers
+    struct Group
+    {
+        size_t firstChannel = 0, numChannels = 0;
+        std::vector<std::unique_ptr<Stage>> stages;
+        std::vector<std::vector<Frame>> frames;     // One buffer per rate, host rate first
+    };
+
+    template <typename BlockType>
+    static void interleave(const Group& group, const BlockType& block, Frame* destination,
+                           size_t numSamples) noexcept
+    {
+        for (size_t lane = 0; lane < group.numChannels; ++lane)
+        {
+            auto* samples = block.getChannelPointer(group.firstChannel + lane);
+
+            for (size_t i = 0; i < numSamples; ++i)
+                destination[i].set(lane, samples[i]);
+        }
+    }
+
+    static void deinterleave(const Group& group, const Frame* source,
+                             juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        for (size_t lane = 0; lane < group.numChannels; ++lane)
+        {
+            auto* samples = block.getChannelPointer(group.firstChannel + lane);
+
+            for (size_t i = 0; i < block.getNumSamples(); ++i)
+                samples[i] = source[i].get(lane);
+        }
+    }
+
+    size_t numChannels, numStages;
+    std::vector<Group> groups;
+    double latency = 0.0;
+
+    juce::AudioBuffer<SampleType> oversampledBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FourKOversampler)
+};
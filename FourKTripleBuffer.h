@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//==============================================================================
+/**
+    Wait-free single-producer / single-consumer triple buffer.
+
+    The writer fills getWriteBuffer() and calls publish(); the reader calls
+    acquire() and, if it returns true, reads the newest value through
+    getReadBuffer(). Neither side ever blocks or allocates, and the reader
+    always sees a complete value - never one the writer is still filling.
+*/
+template <typename ValueType>
+class FourKTripleBuffer
+{
+public:
+    FourKTripleBuffer() = default;
+
+    FourKTripleBuffer(const FourKTripleBuffer&) = delete;
+    FourKTripleBuffer& operator= (const FourKTripleBuffer&) = delete;
+
+    //==============================================================================
+    /** Writer side: the slot owned by the writer until the next publish(). */
+    ValueType& getWriteBuffer() noexcept { return buffers[(size_t) writeIndex]; }
+
+    /** Writer side: hands the write slot to the reader and takes a free one. */
+    void publish() noexcept
+    {
+        auto previous = middle.exchange(writeIndex | freshFlag, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    //==============================================================================
+    /** Reader side: swaps in the newest published value, if there is one. */
+    bool acquire() noexcept
+    {
+        if ((middle.load(std::memory_order_acquire) & freshFlag) == 0)
+            return false;
+
+        auto previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    /** Reader side: the value taken by the last successful acquire(). */
+    const ValueType& getReadBuffer() const noexcept { return buffers[(size_t) readIndex]; }
+
+private:
+    //==============================================================================
+    static constexpr int indexMask = 3;
+    static constexpr int freshFlag = 4;
+
+    std::array<ValueType, 3> buffers {};
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle { 2 };
+};
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+//==============================================================================
+/**
+    Saturator transfer curves as lookup tables, linearly interpolated.
+
+    Each curve is sampled once per process, in double precision, over
+    [-inputLimit, inputLimit] and held flat beyond it; every curve has unit
+    slope and passes through zero at the origin, so switching curves doesn't
+    change the small-signal level. Evaluating one costs the same clamp, table
+    read and multiply-add whatever the curve, and every curve takes the same
+    memory.
+
+    The tanh table stands in for std::tanh to within maxTanhError at any
+    input, float or double. Interpolation dominates: h^2/8 times the peak
+    of |tanh''|, about 1.5e-6 for h = 1/256, worst near |x| = 0.63 where
+    tanh bends hardest; rounding the table to float adds the rest. Past
+    the table it holds tanh(8), 2.3e-7 short of the rail.
+
+    Alongside the table sits its running integral, exact for the
+    interpolated curve (so piecewise quadratic), for antiderivative
+    anti-aliasing. It is kept in double precision and is zero at the origin.
+*/
+class FourKWaveshaper
+{
+public:
+    enum Curve
+    {
+        curveTanh,          // Symmetric soft clip
+        curveOpAmp,         // Linear up to a short knee, then hard against the rails
+        curveTransformer,   // Biased tanh: softer on the positive side, even harmonics
+        numCurves
+    };
+
+    static constexpr float inputLimit = 8.0f;
+    static constexpr int numIntervals = 4096;
+
+    // Largest difference from std::tanh of the curveTanh table; measured
+    // 1.84e-6 in float and 1.49e-6 in double
+    static constexpr double maxTanhError = 2.0e-6;
+
+    /** The shared table for a curve. All of them are built on the first
+        call, which allocates nothing but is not cheap: make it before
+        processing starts.
+    */
+    static const FourKWaveshaper& get(Curve curve)
+    {
+        static const FourKWaveshaper shapers[numCurves] =
+        {
+            FourKWaveshaper(curveTanh),
+            FourKWaveshaper(curveOpAmp),
+            FourKWaveshaper(curveTransformer)
+        };
+
+        return shapers[juce::jlimit(0, numCurves - 1, (int) curve)];
+    }
+
+    /** False for curves that treat the two half-waves differently, and so
+        put DC on what they saturate.
+    */
+    static bool isSymmetric(Curve curve) noexcept
+    {
+        return curve != curveTransformer;
+    }
+
+    /** The curve at x, for float or double samples. The table itself is
+        float either way.
+    */
+    template <typename SampleType>
+    SampleType process(SampleType x) const noexcept
+    {
+        const SampleType position = std::clamp((x + (SampleType) inputLimit) * (SampleType) pointsPerUnit,
+                                               (SampleType) 0, (SampleType) numIntervals);
+        const int index = std::min((int) position, numIntervals - 1);
+        const SampleType fraction = position - (SampleType) index;
+        const SampleType start = values[(size_t) index];
+
+        return start + fraction * ((SampleType) values[(size_t) index + 1] - start);
+    }
+
+    double getIntegral(double x) const noexcept
+    {
+        const double position = ((double) x + inputLimit) * pointsPerUnit;
+
+        // Flat beyond the table, so the integral carries on in a straight line
+        if (position <= 0.0)
+            return integrals.front() + values.front() * (x + inputLimit);
+
+        if (position >= numIntervals)
+            return integrals.back() + values.back() * (x - inputLimit);
+
+        const int index = (int) position;
+        const double fraction = position - index;
+        const double start = values[(size_t) index];
+        const double slope = values[(size_t) index + 1] - start;
+
+        return integrals[(size_t) index] + fraction * (start + 0.5 * fraction * slope) / pointsPerUnit;
+    }
+
+private:
+    static constexpr float pointsPerUnit = numIntervals / (2.0f * inputLimit);
+
+    explicit FourKWaveshaper(Curve curve)
+    {
+        for (int i = 0; i <= numIntervals; ++i)
+            values[(size_t) i] = (float) evaluate(curve, (i - numIntervals / 2) / (double) pointsPerUnit);
+
+        // Trapezoids are exact for the interpolated curve
+        integrals[0] = 0.0;
+
+        for (size_t i = 1; i < integrals.size(); ++i)
+            integrals[i] = integrals[i - 1] + 0.5 * ((double) values[i - 1] + values[i]) / pointsPerUnit;
+
+        const double origin = integrals[numIntervals / 2];
+
+        for (auto& integral : integrals)
+            integral -= origin;
+    }
+
+    static double evaluate(Curve curve, double x)
+    {
+        switch (curve)
+        {
+            case curveOpAmp:
+            {
+                // Unit gain up to the knee, then a parabola that meets the
+                // rail at 1 with zero slope
+                constexpr double knee = 0.5;
+                const double magnitude = std::abs(x);
+
+                if (magnitude <= knee)
+                    return x;
+
+                const double clipped = magnitude >= 2.0 - knee
+                                     ? 1.0
+                                     : magnitude - (magnitude - knee) * (magnitude - knee) / (4.0 * (1.0 - knee));
+
+                return std::copysign(clipped, x);
+            }
+
+            case curveTransformer:
+            {
+                // Shifted and rescaled to keep the origin and unit slope there
+                constexpr double bias = 0.2;
+                const double offset = std::tanh(bias);
+                return (std::tanh(x + bias) - offset) / (1.0 - offset * offset);
+            }
+
+            case curveTanh:
+            case numCurves:
+            default:
+                return std::tanh(x);
+        }
+    }
+
+    std::array<float, numIntervals + 1> values;
+    std::array<double, numIntervals + 1> integrals;
+};
@@ -7,7 +7,7 @@ FourKEQEditor::FourKEQEditor(FourKEQ& p)
     setLookAndFeel(&lookAndFeel);
 
     // Set editor size - professional console proportions
-    setSize(920, 420);
+    setSize(920, 540);
     setResizable(false, false);
 
     // Get parameter references
@@ -90,6 +90,20 @@ FourKEQEditor::FourKEQEditor(FourKEQ& p)
     saturationAttachment = std::make_unique<SliderAttachment>(
         audioProcessor.parameters, "saturation", saturationSlider);
 
+    // Saturator transfer curve
+    saturationCurveSelector.addItem("Tanh", 1);
+    saturationCurveSelector.addItem("Op-Amp", 2);
+    saturationCurveSelector.addItem("Transformer", 3);
+    saturationCurveSelector.setColour(juce::ComboBox::backgroundColourId, juce::Colour(0xff3a3a3a));
+    saturationCurveSelector.setColour(juce::ComboBox::textColourId, juce::Colour(0xffe0e0e0));
+    addAndMakeVisible(saturationCurveSelector);
+    saturationCurveAttachment = std::make_unique<ComboBoxAttachment>(
+        audioProcessor.parameters, "sat_curve", saturationCurveSelector);
+
+    setupButton(saturationAntialiasButton, "ADAA");
+    saturationAntialiasAttachment = std::make_unique<ButtonAttachment>(
+        audioProcessor.parameters, "sat_adaa", saturationAntialiasButton);
+
     // EQ Type selector (styled as SSL switch)
     eqTypeSelector.addItem("BROWN", 1);
     eqTypeSelector.addItem("BLACK", 2);
@@ -101,14 +115,53 @@ FourKEQEditor::FourKEQEditor(FourKEQ& p)
         audioProcessor.parameters, "eq_type", eqTypeSelector);
 
     // Oversampling selector
-    oversamplingSelector.addItem("2x", 1);
-    oversamplingSelector.addItem("4x", 2);
+    oversamplingSelector.addItem("1x", 1);
+    oversamplingSelector.addItem("2x", 2);
+    oversamplingSelector.addItem("4x", 3);
+    oversamplingSelector.addItem("8x", 4);
+    oversamplingSelector.addItem("16x", 5);
+    oversamplingSelector.addItem("Auto", 6);
     oversamplingSelector.setColour(juce::ComboBox::backgroundColourId, juce::Colour(0xff3a3a3a));
     oversamplingSelector.setColour(juce::ComboBox::textColourId, juce::Colour(0xffe0e0e0));
     addAndMakeVisible(oversamplingSelector);
     oversamplingAttachment = std::make_unique<ComboBoxAttachment>(
         audioProcessor.parameters, "oversampling", oversamplingSelector);
 
+    // Oversampling mode: whole chain, or just the saturator
+    oversamplingModeSelector.addItem("Full", 1);
+    oversamplingModeSelector.addItem("Sat Only", 2);
+    oversamplingModeSelector.setColour(juce::ComboBox::backgroundColourId, juce::Colour(0xff3a3a3a));
+    oversamplingModeSelector.setColour(juce::ComboBox::textColourId, juce::Colour(0xffe0e0e0));
+    addAndMakeVisible(oversamplingModeSelector);
+    oversamplingModeAttachment = std::make_unique<ComboBoxAttachment>(
+        audioProcessor.parameters, "os_mode", oversamplingModeSelector);
+
+    // Oversampling filters: minimum or linear phase
+    oversamplingFilterSelector.addItem("Min Phase", 1);
+    oversamplingFilterSelector.addItem("Lin Phase", 2);
+    oversamplingFilterSelector.setColour(juce::ComboBox::backgroundColourId, juce::Colour(0xff3a3a3a));
+    oversamplingFilterSelector.setColour(juce::ComboBox::textColourId, juce::Colour(0xffe0e0e0));
+    addAndMakeVisible(oversamplingFilterSelector);
+    oversamplingFilterAttachment = std::make_unique<ComboBoxAttachment>(
+        audioProcessor.parameters, "os_filter", oversamplingFilterSelector);
+
+    // Oversampling used for offline bounces
+    renderOversamplingSelector.addItem("Render: Live", 1);
+    renderOversamplingSelector.addItem("Render: 4x", 2);
+    renderOversamplingSelector.addItem("Render: 8x", 3);
+    renderOversamplingSelector.addItem("Render: 16x", 4);
+    renderOversamplingSelector.setColour(juce::ComboBox::backgroundColourId, juce::Colour(0xff3a3a3a));
+    renderOversamplingSelector.setColour(juce::ComboBox::textColourId, juce::Colour(0xffe0e0e0));
+    addAndMakeVisible(renderOversamplingSelector);
+    renderOversamplingAttachment = std::make_unique<ComboBoxAttachment>(
+        audioProcessor.parameters, "render_os", renderOversamplingSelector);
+
+    // Rate the saturator actually runs at, which Auto picks per host rate
+    oversampledRateLabel.setJustificationType(juce::Justification::centred);
+    oversampledRateLabel.setFont(juce::Font(juce::FontOptions(9.0f).withStyle("Bold")));
+    oversampledRateLabel.setColour(juce::Label::textColourId, juce::Colour(0xffc0c0c0));
+    addAndMakeVisible(oversampledRateLabel);
+
     // Start timer for UI updates
     startTimerHz(30);
 }
@@ -348,9 +401,15 @@ void FourKEQEditor::resized()
     // Saturation
     auto satBounds = masterSection.removeFromTop(90);
     saturationSlider.setBounds(satBounds.withSizeKeepingCentre(70, 70));
+    saturationCurveSelector.setBounds(masterSection.removeFromTop(30).withSizeKeepingCentre(100, 25));
+    saturationAntialiasButton.setBounds(masterSection.removeFromTop(30).withSizeKeepingCentre(60, 25));
 
     // Oversampling
     oversamplingSelector.setBounds(masterSection.removeFromTop(30).withSizeKeepingCentre(80, 25));
+    oversamplingModeSelector.setBounds(masterSection.removeFromTop(30).withSizeKeepingCentre(80, 25));
+    oversamplingFilterSelector.setBounds(masterSection.removeFromTop(30).withSizeKeepingCentre(80, 25));
+    renderOversamplingSelector.setBounds(masterSection.removeFromTop(30).withSizeKeepingCentre(100, 25));
+    oversampledRateLabel.setBounds(masterSection.removeFromTop(20).withSizeKeepingCentre(100, 16));
 }
 
 void FourKEQEditor::timerCallback()
@@ -362,6 +421,10 @@ void FourKEQEditor::timerCallback()
     lmQSlider.setVisible(true);  // Always visible in both modes
     hmQSlider.setVisible(true);
 
+    auto rate = audioProcessor.getOversampledRate();
+    oversampledRateLabel.setText(rate > 0.0 ? juce::String(rate / 1000.0, 1) + " kHz" : juce::String(),
+                                 juce::dontSendNotification);
+
     repaint();  // Update bypass LED
 }
 
@@ -67,7 +67,13 @@ private:
     juce::ToggleButton bypassButton;
     juce::Slider outputGainSlider;
     juce::Slider saturationSlider;
+    juce::ComboBox saturationCurveSelector;
+    juce::ToggleButton saturationAntialiasButton;
     juce::ComboBox oversamplingSelector;
+    juce::ComboBox oversamplingModeSelector;
+    juce::ComboBox oversamplingFilterSelector;
+    juce::ComboBox renderOversamplingSelector;
+    juce::Label oversampledRateLabel;
 
     // Parameter references for UI updates
     std::atomic<float>* eqTypeParam;
@@ -105,7 +111,12 @@ private:
     std::unique_ptr<ButtonAttachment> bypassAttachment;
     std::unique_ptr<SliderAttachment> outputGainAttachment;
     std::unique_ptr<SliderAttachment> saturationAttachment;
+    std::unique_ptr<ComboBoxAttachment> saturationCurveAttachment;
+    std::unique_ptr<ButtonAttachment> saturationAntialiasAttachment;
     std::unique_ptr<ComboBoxAttachment> oversamplingAttachment;
+    std::unique_ptr<ComboBoxAttachment> oversamplingModeAttachment;
+    std::unique_ptr<ComboBoxAttachment> oversamplingFilterAttachment;
+    std::unique_ptr<ComboBoxAttachment> renderOversamplingAttachment;
 
     // Helper methods
     void setupKnob(juce::Slider& slider, const juce::String& paramID,
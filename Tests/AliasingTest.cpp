@@ -0,0 +1,99 @@
+/*
+    Sweeps a loud sine up through the top octaves into the saturator and
+    measures what folds back: everything below 20 kHz that is neither the
+    fundamental nor one of its in-band harmonics. ADAA at 2x has to buy a
+    real improvement over plain 2x at every step, and plain 4x has to stay
+    clean, so a change to either shows up here rather than by ear.
+*/
+
+#include "FourKEQTestUtilities.h"
+
+class AliasingTest : public juce::UnitTest
+{
+public:
+    AliasingTest() : juce::UnitTest("Saturator aliasing", "FourKEQ") {}
+
+    void runTest() override
+    {
+        for (auto frequency : sweepFrequencies)
+        {
+            beginTest("Aliasing at " + juce::String(frequency / 1000.0) + " kHz");
+
+            auto plain = measureAliasingDb(1, false, frequency);
+            auto antialiased = measureAliasingDb(1, true, frequency);
+
+            logMessage("2x " + juce::String(plain, 1) + " dB, 2x ADAA " + juce::String(antialiased, 1) + " dB");
+
+            expectLessThan(antialiased, plain - minimumImprovementDb, "ADAA improvement at 2x");
+            expectLessThan(antialiased, maxAntialiasedDb, "Aliasing at 2x with ADAA, dB");
+            expectLessThan(measureAliasingDb(2, false, frequency), maxFourTimesDb, "Aliasing at 4x, dB");
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int fftOrder = 13;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr float amplitude = 0.5f;
+
+    // Odd multiples of 1 kHz: none of them has harmonics that fold back
+    // exactly onto its own harmonics at 48 kHz, as fs/4 would
+    static constexpr double sweepFrequencies[] = { 9000.0, 11000.0, 13000.0, 15000.0, 17000.0 };
+
+    // Measured on the same chain: plain 2x sits between -34 and -66 dB
+    // over the sweep, ADAA 15-30 dB below it, 4x below -80 dB
+    static constexpr double minimumImprovementDb = 10.0;
+    static constexpr double maxAntialiasedDb = -55.0;
+    static constexpr double maxFourTimesDb = -75.0;
+
+    /** Aliased power relative to the fundamental, in dB, with the saturator
+        fully in. The sine sits on an FFT bin and the chain has settled, so
+        every product lands on a bin and no window is needed.
+    */
+    double measureAliasingDb(int oversamplingChoice, bool antialias, double frequency)
+    {
+        using namespace FourKEQTestUtilities;
+
+        FourKEQ processor;
+        setFlat(processor);
+        setParameter(processor, "saturation", 100.0f);
+        setParameter(processor, "sat_adaa", antialias ? 1.0f : 0.0f);
+        setParameter(processor, "oversampling", (float) oversamplingChoice);
+        prepare(processor, sampleRate, blockSize);
+
+        const int bin = juce::roundToInt(frequency * fftSize / sampleRate);
+        std::vector<float> input((size_t) (2 * fftSize));
+
+        for (size_t n = 0; n < input.size(); ++n)
+            input[n] = amplitude * (float) std::sin(juce::MathConstants<double>::twoPi * bin
+                                                    * (double) (n % fftSize) / fftSize);
+
+        // The first period covers the latency and lets the filters settle
+        auto output = process(processor, input, blockSize);
+        processor.releaseResources();
+
+        std::vector<float> spectrum((size_t) (2 * fftSize), 0.0f);
+        std::copy(output.begin() + fftSize, output.end(), spectrum.begin());
+
+        juce::dsp::FFT fft(fftOrder);
+        fft.performFrequencyOnlyForwardTransform(spectrum.data());
+
+        const int lastBin = (int) (20000.0 * fftSize / sampleRate);
+        double fundamental = 0.0, aliased = 0.0;
+
+        for (int k = 1; k <= lastBin; ++k)
+        {
+            auto power = (double) spectrum[(size_t) k] * spectrum[(size_t) k];
+
+            if (k == bin)
+                fundamental = power;
+            else if (k % bin != 0)
+                aliased += power;
+        }
+
+        return 10.0 * std::log10(juce::jmax(aliased, 1.0e-30) / fundamental);
+    }
+};
+
+static AliasingTest aliasingTest;
@@ -0,0 +1,96 @@
+/*
+    Hammers automation on a FourKEQ from several threads while the audio
+    thread keeps processing, so that the designer thread, the coefficient
+    hand-off and oversampling switches all run against each other.
+*/
+
+#include "FourKEQTestUtilities.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+class AutomationStressTest : public juce::UnitTest
+{
+public:
+    AutomationStressTest() : juce::UnitTest("Automation stress", "FourKEQ") {}
+
+    void runTest() override
+    {
+        beginTest("Output stays finite under automation from several threads");
+
+        FourKEQ processor;
+        FourKEQTestUtilities::prepare(processor, sampleRate, maxBlockSize);
+
+        std::atomic<bool> automating { true };
+        std::vector<std::thread> automation;
+
+        for (int t = 0; t < numAutomationThreads; ++t)
+        {
+            automation.emplace_back([&processor, &automating, seed = getRandom().nextInt64()]
+            {
+                juce::Random random(seed);
+                auto& parameters = processor.getParameters();
+
+                while (automating.load(std::memory_order_relaxed))
+                {
+                    auto* parameter = parameters[random.nextInt(parameters.size())];
+                    parameter->setValueNotifyingHost(random.nextFloat());
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            });
+        }
+
+        juce::AudioBuffer<float> buffer(2, maxBlockSize);
+        juce::MidiBuffer midi;
+        auto& random = getRandom();
+        int numBadBlocks = 0;
+        const auto endTime = juce::Time::getMillisecondCounter() + (juce::uint32) runTimeMs;
+
+        // Blocks of any size, from single samples up to the most announced
+        while (juce::Time::getMillisecondCounter() < endTime)
+        {
+            buffer.setSize(2, 1 + random.nextInt(maxBlockSize), false, false, true);
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    buffer.setSample(channel, i, 0.25f * (random.nextFloat() * 2.0f - 1.0f));
+
+            processor.processBlock(buffer, midi);
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(channel),
+                                                                        buffer.getNumSamples());
+
+                if (! std::isfinite(range.getStart()) || ! std::isfinite(range.getEnd())
+                    || range.getStart() < -maxOutputLevel || range.getEnd() > maxOutputLevel)
+                {
+                    ++numBadBlocks;
+                }
+            }
+        }
+
+        automating = false;
+
+        for (auto& thread : automation)
+            thread.join();
+
+        expectEquals(numBadBlocks, 0, "Blocks with non-finite or runaway output");
+
+        processor.releaseResources();
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int maxBlockSize = 1024;
+    static constexpr int numAutomationThreads = 4;
+    static constexpr int runTimeMs = 3000;
+
+    // Every band boosting at the same frequency and +12 dB of output gain
+    // still stay well under this on noise at -12 dBFS; anything above it
+    // means a filter has blown up
+    static constexpr float maxOutputLevel = 1.0e5f;
+};
+
+static AutomationStressTest automationStressTest;
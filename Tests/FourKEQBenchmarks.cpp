@@ -0,0 +1,696 @@
+/*
+    Timings for the DSP kernels, against the code they replaced. Not a test:
+    it prints a table and exits, and it is only worth running from an
+    optimised build.
+
+    Each figure is the best of several runs of a few seconds of audio, in
+    nanoseconds per sample of the rate the kernel runs at, so the numbers
+    for different block sizes and factors compare directly.
+*/
+
+#include <JuceHeader.h>
+#include "FourKBiquad.h"
+#include "FourKOversampler.h"
+#include "FourKWaveshaper.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    constexpr double hostSampleRate = 48000.0;
+    constexpr int numRuns = 5;
+    constexpr size_t samplesPerRun = 1 << 18;
+
+    // The processor runs its filters a control interval at a time
+    constexpr size_t chunkLength = 32;
+
+    // Keeps the compiler from dropping work whose result nobody reads
+    volatile float sink = 0.0f;
+
+    template <typename Function>
+    double timeNanosecondsPerSample(size_t samplesPerCall, Function&& function)
+    {
+        const size_t numCalls = std::max((size_t) 1, samplesPerRun / samplesPerCall);
+        double best = std::numeric_limits<double>::max();
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            for (size_t call = 0; call < numCalls; ++call)
+                function();
+
+            const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count() / (double) (numCalls * samplesPerCall));
+        }
+
+        return best;
+    }
+
+    std::vector<float> makeNoise(size_t numSamples, float level)
+    {
+        juce::Random random(1);
+        std::vector<float> noise(numSamples);
+
+        for (auto& sample : noise)
+            sample = level * (random.nextFloat() * 2.0f - 1.0f);
+
+        return noise;
+    }
+
+    // Every call starts from the same input; fed its own output, a chain
+    // with boosts would run away
+    template <typename SampleType>
+    void copyToBothChannels(const std::vector<float>& input, juce::AudioBuffer<SampleType>& buffer)
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            std::copy(input.begin(), input.end(), buffer.getWritePointer(channel));
+    }
+
+    //==============================================================================
+    // A typical setting for every band, designed the way the original code
+    // did, with juce::dsp::IIR::Coefficients
+    using Coefficients = juce::dsp::IIR::Coefficients<float>;
+
+    struct BandSettings
+    {
+        Coefficients::Ptr hpfFirstOrder, hpf, lf, lm, hm, hf, lpf;
+
+        // The original HPF: two biquads rather than a first-order section
+        // and one biquad
+        Coefficients::Ptr originalHpfStage1, originalHpfStage2;
+
+        explicit BandSettings(double sampleRate)
+            : hpfFirstOrder(Coefficients::makeFirstOrderHighPass(sampleRate, 80.0f)),
+              hpf(Coefficients::makeHighPass(sampleRate, 80.0f, 1.0f)),
+              lf(Coefficients::makeLowShelf(sampleRate, 100.0f, 0.7f, juce::Decibels::decibelsToGain(4.0f))),
+              lm(Coefficients::makePeakFilter(sampleRate, 400.0f, 1.5f, juce::Decibels::decibelsToGain(-3.0f))),
+              hm(Coefficients::makePeakFilter(sampleRate, 3000.0f, 2.0f, juce::Decibels::decibelsToGain(3.0f))),
+              hf(Coefficients::makeHighShelf(sampleRate, 10000.0f, 0.7f, juce::Decibels::decibelsToGain(2.0f))),
+              lpf(Coefficients::makeLowPass(sampleRate, 18000.0f, 0.707f)),
+              originalHpfStage1(Coefficients::makeHighPass(sampleRate, 80.0f, 0.54f)),
+              originalHpfStage2(Coefficients::makeHighPass(sampleRate, 80.0f, 1.31f))
+        {
+        }
+
+        std::array<Coefficients::Ptr, 6> getBiquads() const { return { hpf, lf, lm, hm, hf, lpf }; }
+
+        template <typename Cascade>
+        void apply(Cascade& cascade) const
+        {
+            auto* first = hpfFirstOrder->getRawCoefficients();
+            cascade.setFirstOrderCoefficients({ first[0], first[1], first[2] });
+
+            auto biquads = getBiquads();
+
+            for (size_t i = 0; i < biquads.size(); ++i)
+            {
+                auto* c = biquads[i]->getRawCoefficients();
+                cascade.setCoefficients(i, { c[0], c[1], c[2], c[3], c[4] });
+            }
+        }
+    };
+
+    using Frame = juce::dsp::SIMDRegister<float>;
+    using FrameChain = FourKBiquadCascade<Frame, 6>;
+    using MonoChain = FourKBiquadCascade<float, 6>;
+
+    //==============================================================================
+    /** Runs a stereo buffer through the SIMD lanes a chunk at a time, the
+        way processChunk does: each chunk is interleaved into the scratch
+        frames, handed to processFrames and de-interleaved back.
+    */
+    template <typename SampleType, typename FrameFunction>
+    void processInLanes(const juce::dsp::AudioBlock<SampleType>& block,
+                        std::array<juce::dsp::SIMDRegister<SampleType>, chunkLength>& scratch,
+                        FrameFunction&& processFrames)
+    {
+        for (size_t position = 0; position < block.getNumSamples(); position += chunkLength)
+        {
+            for (size_t lane = 0; lane < 2; ++lane)
+            {
+                auto* samples = block.getChannelPointer(lane) + position;
+
+                for (size_t i = 0; i < chunkLength; ++i)
+                    scratch[i].set(lane, samples[i]);
+            }
+
+            processFrames(scratch.data());
+
+            for (size_t lane = 0; lane < 2; ++lane)
+            {
+                auto* samples = block.getChannelPointer(lane) + position;
+
+                for (size_t i = 0; i < chunkLength; ++i)
+                    samples[i] = scratch[i].get(lane);
+            }
+        }
+    }
+
+    template <typename SampleType, typename FrameFunction>
+    void processInLanes(juce::AudioBuffer<SampleType>& buffer,
+                        std::array<juce::dsp::SIMDRegister<SampleType>, chunkLength>& scratch,
+                        FrameFunction&& processFrames)
+    {
+        processInLanes(juce::dsp::AudioBlock<SampleType>(buffer), scratch, processFrames);
+    }
+
+    /** Stereo through the filter chain: one SIMD cascade with a channel per
+        lane, interleaving each chunk in and out as the processor does,
+        against a scalar cascade per channel.
+    */
+    void benchmarkStereoLanes()
+    {
+        std::printf("\nStereo filter chain, SIMD lanes vs a scalar cascade per channel (ns/sample)\n");
+        std::printf("%10s %10s %10s %8s\n", "factor", "scalar", "SIMD", "speedup");
+
+        for (int factor : { 1, 2, 4 })
+        {
+            const double sampleRate = hostSampleRate * factor;
+            const size_t blockSize = 512 * (size_t) factor;
+            const BandSettings settings(sampleRate);
+            const auto noise = makeNoise(blockSize, 0.25f);
+
+            juce::AudioBuffer<float> buffer(2, (int) blockSize);
+
+            std::array<MonoChain, 2> monoChains;
+
+            for (auto& chain : monoChains)
+                settings.apply(chain);
+
+            auto scalar = timeNanosecondsPerSample(blockSize, [&]
+            {
+                copyToBothChannels(noise, buffer);
+
+                for (int channel = 0; channel < 2; ++channel)
+                    for (size_t position = 0; position < blockSize; position += chunkLength)
+                        monoChains[(size_t) channel].process(buffer.getWritePointer(channel) + position, chunkLength);
+
+                sink = buffer.getSample(1, 0);
+            });
+
+            FrameChain frameChain;
+            settings.apply(frameChain);
+            std::array<Frame, chunkLength> scratch;
+            scratch.fill(Frame::expand(0.0f));
+
+            auto simd = timeNanosecondsPerSample(blockSize, [&]
+            {
+                copyToBothChannels(noise, buffer);
+                processInLanes(buffer, scratch, [&] (Frame* frames) { frameChain.process(frames, chunkLength); });
+                sink = buffer.getSample(1, 0);
+            });
+
+            std::printf("%8dx %10.2f %10.2f %7.2fx\n", factor, scalar, simd, scalar / simd);
+        }
+    }
+
+    //==============================================================================
+    /** The oversampled loop processBlock had before the fused kernel: a pair
+        of juce::dsp::IIR::Filter per band, the HPF as two biquads (Q 0.54
+        and 1.31), the channel tested three times per sample, and the
+        saturation amount loaded and std::tanh called for every sample.
+    */
+    struct OriginalLoop
+    {
+        struct Band
+        {
+            juce::dsp::IIR::Filter<float> filter, filterR;
+
+            void setCoefficients(const Coefficients::Ptr& coefficients)
+            {
+                filter.coefficients = coefficients;
+                filterR.coefficients = coefficients;
+            }
+        };
+
+        Band hpfStage1, hpfStage2, lfFilter, lmFilter, hmFilter, hfFilter, lpfFilter;
+        std::atomic<float> saturationParam { 20.0f };
+
+        explicit OriginalLoop(const BandSettings& settings)
+        {
+            hpfStage1.setCoefficients(settings.originalHpfStage1);
+            hpfStage2.setCoefficients(settings.originalHpfStage2);
+            lfFilter.setCoefficients(settings.lf);
+            lmFilter.setCoefficients(settings.lm);
+            hmFilter.setCoefficients(settings.hm);
+            hfFilter.setCoefficients(settings.hf);
+            lpfFilter.setCoefficients(settings.lpf);
+        }
+
+        static float applySaturation(float sample, float amount)
+        {
+            float drive = 1.0f + amount * 2.0f;
+            float saturated = std::tanh(sample * drive);
+
+            return sample * (1.0f - amount) + saturated * amount;
+        }
+
+        void process(juce::AudioBuffer<float>& buffer)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                auto* channelData = buffer.getWritePointer(channel);
+
+                for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                {
+                    float processSample = channelData[sample];
+
+                    if (channel == 0)
+                    {
+                        processSample = hpfStage1.filter.processSample(processSample);
+                        processSample = hpfStage2.filter.processSample(processSample);
+                    }
+                    else
+                    {
+                        processSample = hpfStage1.filterR.processSample(processSample);
+                        processSample = hpfStage2.filterR.processSample(processSample);
+                    }
+
+                    if (channel == 0)
+                    {
+                        processSample = lfFilter.filter.processSample(processSample);
+                        processSample = lmFilter.filter.processSample(processSample);
+                        processSample = hmFilter.filter.processSample(processSample);
+                        processSample = hfFilter.filter.processSample(processSample);
+                    }
+                    else
+                    {
+                        processSample = lfFilter.filterR.processSample(processSample);
+                        processSample = lmFilter.filterR.processSample(processSample);
+                        processSample = hmFilter.filterR.processSample(processSample);
+                        processSample = hfFilter.filterR.processSample(processSample);
+                    }
+
+                    if (channel == 0)
+                        processSample = lpfFilter.filter.processSample(processSample);
+                    else
+                        processSample = lpfFilter.filterR.processSample(processSample);
+
+                    float satAmount = saturationParam.load() * 0.01f;
+                    if (satAmount > 0.0f)
+                        processSample = applySaturation(processSample, satAmount);
+
+                    channelData[sample] = processSample;
+                }
+            }
+        }
+    };
+
+    /** The same drive blend as FourKEQ::applySaturation, through the table
+        curve, over a chunk with its ramp of amounts.
+    */
+    template <typename SampleType>
+    void saturate(SampleType* samples, size_t numSamples, size_t stride, const float* amounts,
+                  const FourKWaveshaper& curve)
+    {
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            for (size_t lane = 0; lane < stride; ++lane)
+            {
+                auto& sample = samples[i * stride + lane];
+                const float drive = 1.0f + amounts[i] * 2.0f;
+
+                sample = sample * (1.0f - amounts[i]) + curve.process(sample * drive) * amounts[i];
+            }
+        }
+    }
+
+    /** Stereo through the whole oversampled chain, filters and saturator,
+        at 2x and 4x: the original loop against the fused cascade, both one
+        channel at a time and in SIMD lanes as the processor runs it.
+    */
+    void benchmarkFusedKernel()
+    {
+        std::printf("\nFilters + saturator at the oversampled rate, original loop vs fused kernel (ns/sample)\n");
+        std::printf("%10s %10s %10s %10s %8s\n", "factor", "original", "fused", "fused SIMD", "speedup");
+
+        const auto& curve = FourKWaveshaper::get(FourKWaveshaper::curveTanh);
+        std::array<float, chunkLength> amounts;
+        amounts.fill(0.2f);
+
+        for (int factor : { 2, 4 })
+        {
+            const double sampleRate = hostSampleRate * factor;
+            const size_t blockSize = 512 * (size_t) factor;
+            const BandSettings settings(sampleRate);
+            const auto noise = makeNoise(blockSize, 0.25f);
+
+            juce::AudioBuffer<float> buffer(2, (int) blockSize);
+
+            OriginalLoop original(settings);
+
+            auto originalTime = timeNanosecondsPerSample(blockSize, [&]
+            {
+                copyToBothChannels(noise, buffer);
+                original.process(buffer);
+                sink = buffer.getSample(1, 0);
+            });
+
+            std::array<MonoChain, 2> monoChains;
+
+            for (auto& chain : monoChains)
+                settings.apply(chain);
+
+            auto fused = timeNanosecondsPerSample(blockSize, [&]
+            {
+                copyToBothChannels(noise, buffer);
+
+                for (int channel = 0; channel < 2; ++channel)
+                {
+                    for (size_t position = 0; position < blockSize; position += chunkLength)
+                    {
+                        auto* samples = buffer.getWritePointer(channel) + position;
+                        monoChains[(size_t) channel].process(samples, chunkLength);
+                        saturate(samples, chunkLength, 1, amounts.data(), curve);
+                    }
+                }
+
+                sink = buffer.getSample(1, 0);
+            });
+
+            FrameChain frameChain;
+            settings.apply(frameChain);
+            std::array<Frame, chunkLength> scratch;
+            scratch.fill(Frame::expand(0.0f));
+
+            auto fusedSimd = timeNanosecondsPerSample(blockSize, [&]
+            {
+                copyToBothChannels(noise, buffer);
+
+                processInLanes(buffer, scratch, [&] (Frame* frames)
+                {
+                    frameChain.process(frames, chunkLength);
+                    saturate(reinterpret_cast<float*>(frames), chunkLength, Frame::size(), amounts.data(), curve);
+                });
+
+                sink = buffer.getSample(1, 0);
+            });
+
+            std::printf("%8dx %10.2f %10.2f %10.2f %7.2fx\n", factor, originalTime, fused, fusedSimd,
+                        originalTime / fusedSimd);
+        }
+    }
+
+    //==============================================================================
+    /** Up and straight back down through either oversampler, which share the
+        processSamplesUp / processSamplesDown interface.
+    */
+    template <typename Oversampler, typename SampleType>
+    double timeRoundTrip(Oversampler& oversampler, juce::AudioBuffer<SampleType>& buffer,
+                         const std::vector<float>& input)
+    {
+        return timeNanosecondsPerSample(input.size(), [&]
+        {
+            copyToBothChannels(input, buffer);
+
+            juce::dsp::AudioBlock<SampleType> block(buffer);
+            oversampler.processSamplesUp(block);
+            oversampler.processSamplesDown(block);
+
+            sink = (float) buffer.getSample(1, 0);
+        });
+    }
+
+    /** Stereo round trips at 2x and 4x, FourKOversampler against
+        juce::dsp::Oversampling with the matching filter type, over the
+        block sizes hosts use. Host-rate samples, so the two factors show
+        what each adds to a block.
+    */
+    void benchmarkOversampling()
+    {
+        using JuceOversampling = juce::dsp::Oversampling<float>;
+
+        struct FilterTypes
+        {
+            const char* name;
+            FourKOversamplerBase::FilterType fourK;
+            JuceOversampling::FilterType juce;
+        };
+
+        for (const auto& types : { FilterTypes { "min phase IIR", FourKOversamplerBase::filterPolyphaseIIR,
+                                                 JuceOversampling::filterHalfBandPolyphaseIIR },
+                                   FilterTypes { "linear phase FIR", FourKOversamplerBase::filterLinearPhaseFIR,
+                                                 JuceOversampling::filterHalfBandFIREquiripple } })
+        {
+            std::printf("\nStereo oversampling round trip, %s, FourKOversampler vs juce::dsp::Oversampling"
+                        " (ns/host sample)\n", types.name);
+            std::printf("%10s %10s %10s %8s %10s %10s %8s\n",
+                        "block", "JUCE 2x", "4K 2x", "speedup", "JUCE 4x", "4K 4x", "speedup");
+
+            for (size_t blockSize = 32; blockSize <= 2048; blockSize *= 2)
+            {
+                const auto noise = makeNoise(blockSize, 0.25f);
+                juce::AudioBuffer<float> buffer(2, (int) blockSize);
+                std::printf("%10d", (int) blockSize);
+
+                for (size_t numStages = 1; numStages <= 2; ++numStages)
+                {
+                    JuceOversampling juceOversampler(2, numStages, types.juce, true, false);
+                    juceOversampler.initProcessing(blockSize);
+
+                    FourKOversampler<float> fourKOversampler(2, numStages, types.fourK);
+                    fourKOversampler.initProcessing(blockSize);
+
+                    auto juceTime = timeRoundTrip(juceOversampler, buffer, noise);
+                    auto fourKTime = timeRoundTrip(fourKOversampler, buffer, noise);
+
+                    std::printf(" %10.2f %10.2f %7.2fx", juceTime, fourKTime, juceTime / fourKTime);
+                }
+
+                std::printf("\n");
+            }
+        }
+    }
+
+    //==============================================================================
+    /** The saturator's drive blend over a block, the same for every curve:
+        only the shape the driven sample goes through changes.
+    */
+    template <typename SampleType, typename Shape>
+    double timeDriveBlend(const std::vector<SampleType>& input, std::vector<SampleType>& buffer, Shape&& shape)
+    {
+        constexpr SampleType amount = (SampleType) 0.2;
+        constexpr SampleType drive = 1 + amount * 2;
+
+        return timeNanosecondsPerSample(input.size(), [&]
+        {
+            std::copy(input.begin(), input.end(), buffer.begin());
+
+            for (auto& sample : buffer)
+                sample = sample * (1 - amount) + shape(sample * drive) * amount;
+
+            sink = (float) buffer[0];
+        });
+    }
+
+    /** std::tanh, as the saturator first called it, against each curve's
+        table, in both precisions the engine runs. Input spans the table's
+        knee and well into its flat ends.
+    */
+    void benchmarkWaveshaper()
+    {
+        std::printf("\nSaturator drive blend, std::tanh vs the curve tables (ns/sample)\n");
+        std::printf("%10s %10s %10s %10s %12s\n", "precision", "std::tanh", "Tanh", "Op-Amp", "Transformer");
+
+        auto run = [] (const char* name, auto zero)
+        {
+            using SampleType = decltype(zero);
+
+            const auto noise = makeNoise(2048, 2.0f);
+            const std::vector<SampleType> input(noise.begin(), noise.end());
+            std::vector<SampleType> buffer(input.size());
+
+            std::printf("%10s %10.2f", name,
+                        timeDriveBlend(input, buffer, [] (SampleType x) { return std::tanh(x); }));
+
+            for (int curve = 0; curve < FourKWaveshaper::numCurves; ++curve)
+            {
+                const auto& shaper = FourKWaveshaper::get((FourKWaveshaper::Curve) curve);
+                std::printf(curve == FourKWaveshaper::curveTransformer ? " %12.2f" : " %10.2f",
+                            timeDriveBlend(input, buffer, [&shaper] (SampleType x) { return shaper.process(x); }));
+            }
+
+            std::printf("\n");
+        };
+
+        run("float", 0.0f);
+        run("double", 0.0);
+    }
+
+    //==============================================================================
+    /** Stereo through the filter cascade in SIMD lanes, at the oversampled
+        rate, in ns per oversampled sample.
+    */
+    template <typename SampleType>
+    double timeCascade(int factor)
+    {
+        using PrecisionFrame = juce::dsp::SIMDRegister<SampleType>;
+
+        const size_t blockSize = 512 * (size_t) factor;
+        const auto noise = makeNoise(blockSize, 0.25f);
+        juce::AudioBuffer<SampleType> buffer(2, (int) blockSize);
+
+        FourKBiquadCascade<PrecisionFrame, 6> chain;
+        BandSettings(hostSampleRate * factor).apply(chain);
+
+        std::array<PrecisionFrame, chunkLength> scratch;
+        scratch.fill(PrecisionFrame::expand((SampleType) 0));
+
+        return timeNanosecondsPerSample(blockSize, [&]
+        {
+            copyToBothChannels(noise, buffer);
+            processInLanes(buffer, scratch, [&] (PrecisionFrame* frames) { chain.process(frames, chunkLength); });
+            sink = (float) buffer.getSample(1, 0);
+        });
+    }
+
+    /** Stereo round trip through FourKOversampler, in ns per host sample. */
+    template <typename SampleType>
+    double timeOversampler(size_t numStages, FourKOversamplerBase::FilterType type)
+    {
+        const size_t blockSize = 512;
+        const auto noise = makeNoise(blockSize, 0.25f);
+        juce::AudioBuffer<SampleType> buffer(2, (int) blockSize);
+
+        FourKOversampler<SampleType> oversampler(2, numStages, type);
+        oversampler.initProcessing(blockSize);
+
+        return timeRoundTrip(oversampler, buffer, noise);
+    }
+
+    /** The engine in float against the engine in double, as the host
+        picks: the cascade and both oversampler types at 2x and 4x. A
+        stereo pair fills a register in either precision.
+    */
+    void benchmarkPrecision()
+    {
+        std::printf("\nStereo, float vs double engine (cascade: ns/oversampled sample,"
+                    " oversampler: ns/host sample)\n");
+        std::printf("%22s %10s %10s %8s\n", "", "float", "double", "ratio");
+
+        auto print = [] (const char* name, int factor, double floatTime, double doubleTime)
+        {
+            std::printf("%18s %2dx %10.2f %10.2f %7.2fx\n", name, factor, floatTime, doubleTime,
+                        doubleTime / floatTime);
+        };
+
+        for (int factor : { 2, 4 })
+            print("filter cascade", factor, timeCascade<float>(factor), timeCascade<double>(factor));
+
+        for (size_t numStages = 1; numStages <= 2; ++numStages)
+        {
+            const auto type = FourKOversamplerBase::filterPolyphaseIIR;
+            print("min phase OS", 1 << numStages, timeOversampler<float>(numStages, type),
+                  timeOversampler<double>(numStages, type));
+        }
+
+        for (size_t numStages = 1; numStages <= 2; ++numStages)
+        {
+            const auto type = FourKOversamplerBase::filterLinearPhaseFIR;
+            print("linear phase OS", 1 << numStages, timeOversampler<float>(numStages, type),
+                  timeOversampler<double>(numStages, type));
+        }
+    }
+
+    //==============================================================================
+    /** What each oversampling mode costs a stereo instance: the filter and
+        saturator kernel at the oversampled rate plus the min phase
+        round trip, per host sample, and as a share of one core at 48 kHz.
+        "Auto" is 4x at 48 kHz.
+    */
+    void benchmarkModes()
+    {
+        std::printf("\nStereo filters + saturator + min phase oversampling per mode at 48 kHz\n");
+        std::printf("%10s %12s %10s\n", "mode", "ns/sample", "% of core");
+
+        const auto& curve = FourKWaveshaper::get(FourKWaveshaper::curveTanh);
+        std::array<float, chunkLength> amounts;
+        amounts.fill(0.2f);
+
+        const size_t blockSize = 512;
+        const auto noise = makeNoise(blockSize, 0.25f);
+        juce::AudioBuffer<float> buffer(2, (int) blockSize);
+
+        struct Mode
+        {
+            const char* name;
+            size_t numStages;
+        };
+
+        for (const auto& mode : { Mode { "1x", 0 }, Mode { "2x", 1 }, Mode { "4x", 2 }, Mode { "8x", 3 },
+                                  Mode { "16x", 4 }, Mode { "Auto", 2 } })
+        {
+            const size_t factor = (size_t) 1 << mode.numStages;
+
+            FrameChain chain;
+            BandSettings(hostSampleRate * (double) factor).apply(chain);
+
+            std::array<Frame, chunkLength> scratch;
+            scratch.fill(Frame::expand(0.0f));
+
+            auto runKernel = [&] (const juce::dsp::AudioBlock<float>& block)
+            {
+                processInLanes(block, scratch, [&] (Frame* frames)
+                {
+                    chain.process(frames, chunkLength);
+                    saturate(reinterpret_cast<float*>(frames), chunkLength, Frame::size(), amounts.data(), curve);
+                });
+            };
+
+            double time = 0.0;
+
+            if (mode.numStages == 0)
+            {
+                time = timeNanosecondsPerSample(blockSize, [&]
+                {
+                    copyToBothChannels(noise, buffer);
+                    runKernel(juce::dsp::AudioBlock<float>(buffer));
+                    sink = buffer.getSample(1, 0);
+                });
+            }
+            else
+            {
+                FourKOversampler<float> oversampler(2, mode.numStages, FourKOversamplerBase::filterPolyphaseIIR);
+                oversampler.initProcessing(blockSize);
+
+                time = timeNanosecondsPerSample(blockSize, [&]
+                {
+                    copyToBothChannels(noise, buffer);
+
+                    juce::dsp::AudioBlock<float> block(buffer);
+                    runKernel(oversampler.processSamplesUp(block));
+                    oversampler.processSamplesDown(block);
+
+                    sink = buffer.getSample(1, 0);
+                });
+            }
+
+            std::printf("%10s %12.2f %9.2f%%\n", mode.name, time, time * hostSampleRate * 1.0e-7);
+        }
+    }
+}
+
+//==============================================================================
+int main()
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    std::printf("FourKEQ benchmarks, %d lanes per SIMD register\n", (int) Frame::size());
+
+    benchmarkStereoLanes();
+    benchmarkFusedKernel();
+    benchmarkOversampling();
+    benchmarkWaveshaper();
+    benchmarkPrecision();
+    benchmarkModes();
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "FourKEQ.h"
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+//==============================================================================
+/**
+    Host-side helpers shared by the processor tests.
+*/
+namespace FourKEQTestUtilities
+{
+    /** Sets a parameter in its own units (Hz, dB, %, choice index), as
+        automation from the host would.
+    */
+    inline void setParameter(FourKEQ& processor, const juce::String& parameterID, float value)
+    {
+        auto* parameter = processor.parameters.getParameter(parameterID);
+        jassert(parameter != nullptr);
+
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    /** Every band flat, the filters parked, no saturation and no
+        oversampling: a chain that passes the signal through unchanged.
+    */
+    inline void setFlat(FourKEQ& processor)
+    {
+        for (auto* id : { "lf_gain", "lm_gain", "hm_gain", "hf_gain", "output_gain", "saturation" })
+            setParameter(processor, id, 0.0f);
+
+        setParameter(processor, "hpf_freq", processor.parameters.getParameterRange("hpf_freq").start);
+        setParameter(processor, "lpf_freq", processor.parameters.getParameterRange("lpf_freq").end);
+        setParameter(processor, "oversampling", 0.0f);
+    }
+
+    /** Prepares for stereo at the given rate. Parameters set before this
+        are designed for synchronously, so the first block already has them.
+    */
+    inline void prepare(FourKEQ& processor, double sampleRate, int blockSize)
+    {
+        processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+    }
+
+    /** Runs a signal through both channels, in blocks of the given size,
+        and returns the left output.
+    */
+    inline std::vector<float> process(FourKEQ& processor, const std::vector<float>& input, int blockSize)
+    {
+        std::vector<float> output(input.size());
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+
+        for (size_t position = 0; position < input.size(); position += (size_t) blockSize)
+        {
+            auto numSamples = (int) juce::jmin((size_t) blockSize, input.size() - position);
+            buffer.setSize(2, numSamples, false, false, true);
+
+            for (int channel = 0; channel < 2; ++channel)
+                std::copy_n(input.data() + position, numSamples, buffer.getWritePointer(channel));
+
+            processor.processBlock(buffer, midi);
+            std::copy_n(buffer.getReadPointer(0), numSamples, output.data() + position);
+        }
+
+        return output;
+    }
+
+    /** Magnitude of a signal's spectrum at one frequency, in dB, by a
+        direct DFT. For an impulse response that is the magnitude response.
+    */
+    inline double getMagnitudeDb(const std::vector<float>& signal, double frequency, double sampleRate)
+    {
+        std::complex<double> sum;
+        const double w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+
+        for (size_t n = 0; n < signal.size(); ++n)
+            sum += (double) signal[n] * std::polar(1.0, -w * (double) n);
+
+        return juce::Decibels::gainToDecibels(std::abs(sum), -400.0);
+    }
+}
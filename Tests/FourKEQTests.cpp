@@ -0,0 +1,22 @@
+/*
+    Runs every juce::UnitTest in the "FourKEQ" category. Each test drives a
+    FourKEQ the way a host would; the exit code is non-zero if any failed.
+*/
+
+#include <JuceHeader.h>
+
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("FourKEQ");
+
+    int failures = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+/*
+    The HPF is a 3rd order Butterworth, a first-order section ahead of a
+    biquad, so it should fall at 18 dB/oct below the cutoff and be 3 dB
+    down at it. Measured on the impulse response of the whole chain with
+    everything else flat: at 1x, where the filters use the matched designs,
+    and at 4x, where they use bilinear designs at the oversampled rate.
+*/
+
+#include "FourKEQTestUtilities.h"
+
+class HighPassSlopeTest : public juce::UnitTest
+{
+public:
+    HighPassSlopeTest() : juce::UnitTest("HPF slope", "FourKEQ") {}
+
+    void runTest() override
+    {
+        beginTest("18 dB/oct at 1x (matched designs)");
+        checkResponse(0, 0.0f, 1.0f);
+
+        // The filters only run oversampled with the saturator in. At this
+        // level and 1% it is linear to well under the tolerances here.
+        beginTest("18 dB/oct at 4x (bilinear designs)");
+        checkResponse(2, 1.0f, 0.01f);
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int responseLength = 1 << 15;
+    static constexpr float cutoff = 500.0f;
+
+    void checkResponse(int oversamplingChoice, float saturation, float impulseLevel)
+    {
+        using namespace FourKEQTestUtilities;
+
+        FourKEQ processor;
+        setFlat(processor);
+        setParameter(processor, "hpf_freq", cutoff);
+        setParameter(processor, "oversampling", (float) oversamplingChoice);
+        setParameter(processor, "saturation", saturation);
+        prepare(processor, sampleRate, blockSize);
+
+        std::vector<float> impulse((size_t) responseLength, 0.0f);
+        impulse[0] = impulseLevel;
+
+        auto response = process(processor, impulse, blockSize);
+        auto levelDb = juce::Decibels::gainToDecibels((double) impulseLevel);
+
+        auto getResponseDb = [&] (double frequency)
+        {
+            return getMagnitudeDb(response, frequency, sampleRate) - levelDb;
+        };
+
+        // Far enough below the cutoff for the asymptote, far enough above
+        // the noise floor for the measurement
+        auto slope = getResponseDb(cutoff / 4.0) - getResponseDb(cutoff / 8.0);
+
+        expectWithinAbsoluteError(slope, 18.06, 0.5, "Slope between fc/8 and fc/4, dB/oct");
+        expectWithinAbsoluteError(getResponseDb(cutoff), -3.01, 0.5, "Response at the cutoff, dB");
+        expectWithinAbsoluteError(getResponseDb(cutoff * 8.0), 0.0, 0.1, "Passband, dB");
+
+        processor.releaseResources();
+    }
+};
+
+static HighPassSlopeTest highPassSlopeTest;
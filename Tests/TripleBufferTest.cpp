@@ -0,0 +1,166 @@
+/*
+    Stress test for the coefficient hand-off between the designer thread
+    and the audio thread (FourKTripleBuffer).
+
+    Several automation threads keep moving a set of parameters. A designer
+    thread turns each snapshot of them into a coefficient set - every entry
+    derived from the snapshot, so a torn set can be recognised - and
+    publishes it. An audio thread acquires whatever is newest, as
+    processBlock does, and checks that each set it sees is complete, newer
+    than the last one, and that the very last set published is the one it
+    ends up with.
+*/
+
+#include "FourKTripleBuffer.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int numAutomationThreads = 4;
+    constexpr int numParameters = 8;
+    constexpr size_t numCoefficients = 48;
+    constexpr auto runTime = std::chrono::seconds(2);
+
+    using Snapshot = std::array<std::uint32_t, numParameters>;
+
+    struct CoefficientSet
+    {
+        std::uint64_t version = 0;
+        Snapshot snapshot {};
+        std::array<double, numCoefficients> coefficients {};
+    };
+
+    double design(const Snapshot& snapshot, size_t index)
+    {
+        return (double) snapshot[index % numParameters] * (double) (index + 1) + 0.25;
+    }
+
+    bool isComplete(const CoefficientSet& set)
+    {
+        for (size_t i = 0; i < numCoefficients; ++i)
+            if (set.coefficients[i] != design(set.snapshot, i))
+                return false;
+
+        return true;
+    }
+}
+
+int main()
+{
+    std::array<std::atomic<std::uint32_t>, numParameters> parameters {};
+    FourKTripleBuffer<CoefficientSet> handoff;
+
+    std::atomic<bool> automating { true };
+    std::atomic<bool> designing { true };
+    std::atomic<bool> processing { true };
+    std::atomic<std::uint64_t> lastPublished { 0 };
+
+    std::uint64_t numAcquired = 0, numTorn = 0, numOutOfOrder = 0, lastSeen = 0;
+
+    std::vector<std::thread> automation;
+
+    for (int t = 0; t < numAutomationThreads; ++t)
+    {
+        automation.emplace_back([&, t]
+        {
+            std::mt19937 random((unsigned) t + 1);
+
+            // Yielding lets every thread in on machines with few cores
+            while (automating.load(std::memory_order_relaxed))
+            {
+                parameters[random() % numParameters].store((std::uint32_t) random(), std::memory_order_relaxed);
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    std::thread designer([&]
+    {
+        std::uint64_t version = 0;
+
+        auto publishSnapshot = [&]
+        {
+            auto& set = handoff.getWriteBuffer();
+            set.version = ++version;
+
+            for (size_t i = 0; i < numParameters; ++i)
+                set.snapshot[i] = parameters[i].load(std::memory_order_relaxed);
+
+            for (size_t i = 0; i < numCoefficients; ++i)
+                set.coefficients[i] = design(set.snapshot, i);
+
+            handoff.publish();
+            lastPublished.store(version, std::memory_order_release);
+        };
+
+        while (designing.load(std::memory_order_relaxed))
+        {
+            publishSnapshot();
+            std::this_thread::yield();
+        }
+
+        // Automation has stopped: one last set, which the audio thread has
+        // to end up with
+        publishSnapshot();
+    });
+
+    std::thread audio([&]
+    {
+        auto acquireNewest = [&]
+        {
+            if (! handoff.acquire())
+                return;
+
+            const auto& set = handoff.getReadBuffer();
+            ++numAcquired;
+
+            if (! isComplete(set))
+                ++numTorn;
+
+            if (set.version <= lastSeen)
+                ++numOutOfOrder;
+
+            lastSeen = set.version;
+        };
+
+        while (processing.load(std::memory_order_acquire))
+        {
+            acquireNewest();
+            std::this_thread::yield();
+        }
+
+        acquireNewest();
+    });
+
+    std::this_thread::sleep_for(runTime);
+
+    automating = false;
+
+    for (auto& thread : automation)
+        thread.join();
+
+    designing = false;
+    designer.join();
+
+    processing.store(false, std::memory_order_release);
+    audio.join();
+
+    const auto published = lastPublished.load();
+    const bool passed = numTorn == 0 && numOutOfOrder == 0 && numAcquired > 0 && lastSeen == published;
+
+    std::printf("%llu sets published, %llu acquired, %llu torn, %llu out of order, last seen %llu of %llu: %s\n",
+                (unsigned long long) published, (unsigned long long) numAcquired,
+                (unsigned long long) numTorn, (unsigned long long) numOutOfOrder,
+                (unsigned long long) lastSeen, (unsigned long long) published,
+                passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
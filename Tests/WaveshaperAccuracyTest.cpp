@@ -0,0 +1,47 @@
+/*
+    The tanh table stands in for std::tanh in the saturator. Sweeps it
+    densely over the table and well past its ends, in both precisions the
+    engine runs, and holds it to the bound FourKWaveshaper documents.
+*/
+
+#include <JuceHeader.h>
+#include "FourKWaveshaper.h"
+
+class WaveshaperAccuracyTest : public juce::UnitTest
+{
+public:
+    WaveshaperAccuracyTest() : juce::UnitTest("Waveshaper accuracy", "FourKEQ") {}
+
+    void runTest() override
+    {
+        beginTest("Tanh table against std::tanh, float");
+        expectLessOrEqual(getMaxError<float>(), FourKWaveshaper::maxTanhError, "Largest error");
+
+        beginTest("Tanh table against std::tanh, double");
+        expectLessOrEqual(getMaxError<double>(), FourKWaveshaper::maxTanhError, "Largest error");
+    }
+
+private:
+    // Several points per table interval, so the middle of every interval,
+    // where interpolation is furthest off, is covered
+    static constexpr double sweepLimit = 3.0 * FourKWaveshaper::inputLimit;
+    static constexpr int numPoints = 1 << 21;
+
+    template <typename SampleType>
+    static double getMaxError()
+    {
+        const auto& curve = FourKWaveshaper::get(FourKWaveshaper::curveTanh);
+        double maxError = 0.0;
+
+        for (int i = 0; i <= numPoints; ++i)
+        {
+            auto x = (SampleType) (sweepLimit * (2.0 * i / numPoints - 1.0));
+            auto error = std::abs((double) curve.process(x) - std::tanh((double) x));
+            maxError = juce::jmax(maxError, error);
+        }
+
+        return maxError;
+    }
+};
+
+static WaveshaperAccuracyTest waveshaperAccuracyTest;